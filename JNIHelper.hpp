@@ -8,6 +8,33 @@
 /**
 * Changelog:
 *
+* ===> Version 1.2.0:
+* > Parallel in-place transform of java primitive arrays
+* > Byte, char and short types and their arrays
+* > Direct byte buffers (DirectBuffer, DirectBufferView)
+* > Recycling pool of direct byte buffers (DirectBufferPool)
+* > Memory-mapped files shared with java (mapFileToJava)
+* > Lock-free ring buffer shared with java (SharedRingBuffer)
+* > Java strings use UTF-16 with fast transcoding to standard UTF-8
+* > Allocation-free java string access (JStringView, jstringToBuffer)
+* > Interned java strings for literals and repeated text (JH_INTERNED_JSTRING, internedJString)
+* > Bulk string array conversion (toJavaStringArray, fromJavaStringArray)
+* > Typed local, global and weak references (LocalRef, GlobalRef, WeakRef)
+* > Reference-counted shared global references (SharedJavaObject)
+* > Deferred deletion of global references in threads without JNIEnv
+* > Local reference budget: class references of calls are freed, LocalReferenceFrame::popKeeping, jh::ensureLocalCapacity, jh::forEachInLocalFrames and jh::forEachArrayElement
+* > JavaObjectWrapper::usePeerField: native methods find their wrapper through a java 'long' field in constant time
+* > JavaObjectWrapper objects are kept in a sharded thread safe registry keyed by System.identityHashCode
+* > C++17 registerNativeMethod<&Wrapper::method>(name): deduced signatures, no ids, no std::function on the native call path; the test app is built with C++17
+* > JavaObjectWrapper native methods are registered exactly once with std::call_once; failures are not retried
+* > Static native method tables (JH_NATIVE_METHOD_TABLE) registered with one FindClass and RegisterNatives per class by jh::registerAllNatives, with per-class timings
+* > Native methods registered by member pointer can take std::string_view, std::string, jh::Span and std::vector arguments and return std::string and std::vector (see NativeArgument and NativeResult)
+* > Java-owned native peers (com.jnihelper.NativePeer, JavaNativePeer): created by java constructors from a per-class slab, destroyed by close() or a PhantomReference cleaner
+* > Optional call counters and HDR-style latency histograms of native methods (JH_NATIVE_METHOD_STATS, jh::nativeMethodStats, com.jnihelper.NativeMethodStats.dump)
+* > Classes and method IDs of java calls are cached (JavaMethodCache); optional per-method lookup and call latency profiling with rate-limited slow call logging (setJavaCallProfilingEnabled, javaCallProfiles)
+* > jh::stats(): global counters of class and member lookups, method cache hits, live references, local frame peaks, thread attaches, created java objects and copied bytes
+* > Desktop JVM microbenchmarks of calls, object creation, arrays, strings, object pointers and native dispatch with CSV output (_bench, needs a local JDK)
+*
 * ===> Version 1.1.0:
 * > Java array support (arrays like 'int[]')
 * > Static native methods registration
@@ -45,6 +72,9 @@
 *     .add(v.begin(), v.end())  // iterators
 *     .build());
 *
+* // Create byte array (also int16_t for short[] and char16_t for char[]):
+* jbyteArray byteArray = jh::JavaArrayBuilder<int8_t>().add({1, 2, 3}).build();
+*
 * // Parse java int array:
 * auto stdIntVector = jh::jarrayToVector<jintArray>(intArray);
 * for (auto i : stdIntVector) {
@@ -61,6 +91,102 @@
 */
 #include "_android/arrays/ArrayBuilder.hpp"
 
+/**
+* ==================== STRING ARRAYS ====================
+* @code{.cpp}
+*
+* // Bulk conversion with a constant number of JNI calls (needs 'com.jnihelper.StringArrays'):
+* jobjectArray javaNames = jh::toJavaStringArray(std::vector<std::string>{"one", "two"});
+* std::vector<std::string> names = jh::fromJavaStringArray(javaNames);
+*
+* @endcode
+*/
+#include "_android/arrays/StringArrays.hpp"
+
+/**
+* ==================== PARALLEL ARRAY TRANSFORM ====================
+* @code{.cpp}
+*
+* // Pool with 8 threads; should be created once and reused:
+* static jh::ThreadPool pool(8);
+*
+* // Normalize java float array in place (kernel must not make JNI calls):
+* jh::parallelTransform(floatArray, [] (jfloat* first, jfloat* last) {
+*     for (auto it = first; it != last; ++it) {
+*         *it = *it / 255.0f;
+*     }
+* }, pool);
+*
+* @endcode
+*/
+#include "_android/arrays/ArrayTransform.hpp"
+
+/**
+* ==================== DIRECT BUFFERS ====================
+* @code{.cpp}
+*
+* // Wrap native memory as 'java.nio.ByteBuffer' (no copy):
+* jh::DirectBuffer frame(pixels, width * height * 4);
+* jh::callMethod<void, jh::DirectBuffer>(someObject, "onFrame", frame);
+*
+* // Read the direct buffer allocated by java without copying:
+* jh::DirectBufferView view(jh::callMethod<jh::DirectBuffer>(someObject, "getBuffer"));
+* process(view.data(), view.size());
+*
+* @endcode
+*/
+#include "_android/buffers/DirectBuffer.hpp"
+
+/**
+* ==================== DIRECT BUFFER POOL ====================
+* @code{.cpp}
+*
+* // Pool with size classes from 4 KB to 8 MB, keeping up to 4 idle buffers per class:
+* static jh::DirectBufferPool pool(4 * 1024, 8 * 1024 * 1024, 4);
+*
+* {
+*     // Take a buffer that is at least 'frameSize' bytes long:
+*     jh::DirectBufferPool::Lease frame = pool.acquire(frameSize);
+*     jh::callMethod<void, jh::DirectBuffer>(someObject, "onFrame", frame);
+*
+* // The buffer returns to the pool here.
+* }
+*
+* @endcode
+*/
+#include "_android/buffers/DirectBufferPool.hpp"
+
+/**
+* ==================== MAPPED FILES ====================
+* @code{.cpp}
+*
+* // Map the file and share its pages with java as read-only 'java.nio.ByteBuffer':
+* jh::MappedFile assets = jh::mapFileToJava(path, offset, length, jh::MappingAccess::Sequential);
+* jh::callMethod<void, jh::DirectBuffer>(someObject, "setAssets", assets);
+*
+* // Unmapped on release() or destruction:
+* assets.release();
+*
+* @endcode
+*/
+#include "_android/buffers/MappedFile.hpp"
+
+/**
+* ==================== SHARED RING BUFFER ====================
+* @code{.cpp}
+*
+* // Ring written by several C++ threads and drained by 'com.jnihelper.SharedRingBuffer' in java:
+* static jh::SharedRingBuffer telemetry(1024 * 1024, jh::RingProducers::Multiple);
+* jh::callMethod<void, jh::SharedRingBuffer>(someObject, "setTelemetry", telemetry);
+*
+* // Publish records without JNI calls and wake the consumer once per batch:
+* telemetry.publish(message.data(), message.size());
+* telemetry.notifyConsumer();
+*
+* @endcode
+*/
+#include "_android/buffers/SharedRingBuffer.hpp"
+
 /**
 * ==================== STATIC CALLS ====================
 * @code{.cpp}
@@ -122,6 +248,23 @@
 */
 #include "_android/calls/ObjectCreation.hpp"
 
+/**
+* ==================== JAVA CALL PROFILING ====================
+* @code{.cpp}
+*
+* // Classes and method IDs of all calls are cached; the cache can be inspected:
+* jh::JavaMethodCacheStatistics cache = jh::javaMethodCacheStatistics();
+*
+* // Per-method latency of callMethod, callStaticMethod and createNewObject (off by default):
+* jh::setJavaCallProfilingEnabled(true);
+* jh::setSlowJavaCallThreshold(5000000, 10);
+* for (const jh::JavaCallProfile& profile : jh::javaCallProfiles())
+*     log(profile.className + "." + profile.methodName, profile.lookup.p50Nanoseconds, profile.call.p99Nanoseconds);
+*
+* @endcode
+*/
+#include "_android/calls/JavaCallProfiler.hpp"
+
 /**
 * ==================== JAVA CUSTOM CLASSES ====================
 * @code{.cpp}
@@ -159,6 +302,21 @@
 */
 #include "_android/core/JNIEnvironment.hpp"
 
+/**
+* ==================== LIBRARY STATISTICS ====================
+* @code{.cpp}
+*
+* // Counters are never reset; exporters should report the differences between snapshots:
+* jh::Statistics before = jh::stats();
+* ...
+* jh::Statistics after = jh::stats();
+* metrics.counter("jni.class_lookups", after.classLookups - before.classLookups);
+* metrics.gauge("jni.global_refs", after.liveGlobalReferences);
+*
+* @endcode
+*/
+#include "_android/core/Statistics.hpp"
+
 /**
 * ==================== JAVA OBJECT WRAPPER ====================
 * @code{.java}
@@ -169,6 +327,9 @@
 * public class Example
 * {
 *     ...
+*     // Optional: pointer to the C++ wrapper, makes native calls O(1) (see 'usePeerField'):
+*     private long nativeHandle;
+*
 *     protected native void someVoidMethod();
 *     protected native int sumTwo(int x, int y);
 *     ...
@@ -187,11 +348,20 @@
 *     // We need to implement two abstract methods - 'linkJavaNativeMethods' and 'initializeJavaObject'.
 *
 *     // Inside 'linkJavaNativeMethods' method we should register all native methods of the wrapped class.
-*     // First argument should be unique method ID for this wrapper class:
+*     // The method itself is the template argument and the signature is deduced (C++17):
 *     void linkJavaNativeMethods() override
 *     {
-*         registerNativeMethod<1, void>("someVoidMethod", &ExampleWrapper::interstitialPressed);
-*         registerNativeMethod<2, int, int, int>("sumTwo", &ExampleWrapper::interstitialClosed);
+*         registerNativeMethod<&ExampleWrapper::someVoidMethod>("someVoidMethod");
+*         registerNativeMethod<&ExampleWrapper::sumTwo>("sumTwo");
+*
+*         // Java types should be listed for custom classes and object arrays:
+*         //     registerNativeMethod<&ExampleWrapper::join, jstring, jh::JavaArray<jstring>>("join");
+*
+*         // C++11 version; first argument should be unique method ID for this wrapper class:
+*         //     registerNativeMethod<1, int, int, int>("sumTwo", &ExampleWrapper::sumTwo);
+*
+*         // Native calls find the wrapper through the java field instead of searching all wrappers:
+*         usePeerField("nativeHandle");
 *     }
 *
 *     // Inside 'initializeJavaObject' method we should created and return an instance of wrapped java class.
@@ -235,6 +405,81 @@
 */
 #include "_android/native/JavaNativeMethod.hpp"
 
+/**
+* ==================== NATIVE METHOD TABLES ====================
+* @code{.cpp}
+*
+* // Native functions get the environment and the class (or the object for instance methods):
+* jint sum(JNIEnv*, jclass, jint x, jint y) { return x + y; }
+* jstring echo(JNIEnv*, jclass, jstring s) { return s; }
+*
+* // Declare the table of native methods of some java class (at namespace scope):
+* JH_NATIVE_METHOD_TABLE(JavaExample,
+*     JH_NATIVE_METHOD("sum", "(II)I", &sum),
+*     JH_NATIVE_METHOD("echo", "(Ljava/lang/String;)Ljava/lang/String;", &echo)
+* );
+*
+* // Register the methods of all tables (for example, in JNI_OnLoad):
+* std::vector<jh::NativeRegistrationTiming> timings;
+* if (!jh::registerAllNatives(&timings))
+*     log("some classes were not registered");
+*
+* @endcode
+*/
+#include "_android/native/NativeMethodTable.hpp"
+
+/**
+* ==================== NATIVE ARGUMENTS (C++17) ====================
+* @code{.cpp}
+*
+* // Native methods of the wrappers can take and return C++ types; signatures are deduced:
+* registerNativeMethod<&ExampleWrapper::describe>("describe");
+*
+* // Java string is borrowed and int array is pinned until the method returns,
+* // float array is copied with one region copy; the result becomes a java string:
+* std::string describe(std::string_view name, jh::Span<const jint> ids, const std::vector<jfloat>& weights);
+*
+* // Elements of the non-const span are written back to the java array:
+* void normalize(jh::Span<jfloat> values);
+*
+* @endcode
+*/
+#include "_android/native/NativeArgument.hpp"
+
+/**
+* ==================== NATIVE METHOD STATISTICS ====================
+* @code{.cpp}
+*
+* // Build with -DJH_NATIVE_METHOD_STATS to count the calls of all registered native methods:
+* for (const jh::NativeMethodStatistics& method : jh::nativeMethodStats())
+*     log(method.className + "." + method.methodName, method.latency.calls, method.latency.p99Nanoseconds);
+*
+* // Java can get the same data as text with 'com.jnihelper.NativeMethodStats.dump()':
+* jh::registerNativeMethodStatsDump();
+*
+* @endcode
+*/
+#include "_android/native/NativeMethodStats.hpp"
+
+/**
+* ==================== JAVA-OWNED NATIVE PEERS ====================
+* @code{.cpp}
+*
+* // Java class extends com.jnihelper.NativePeer, its C++ peer extends jh::JavaNativePeer:
+* class Counter : public jh::JavaNativePeer<JavaCounter, Counter>
+* {
+* public:
+*     static void linkJavaNativeMethods() { registerNativeMethod<&Counter::increment>("increment"); }
+*     int increment() { return ++m_value; }
+* };
+*
+* // Java constructors create peers from the per-class slab, 'close()' or the collection destroys them:
+* Counter::registerPeerClass();
+*
+* @endcode
+*/
+#include "_android/native/JavaNativePeer.hpp"
+
 /**
 * ==================== LOCAL REFERENCE FRAME ====================
 * @code{.cpp}
@@ -263,6 +508,27 @@
 * // Both strings are still alive!
 * log(jh::jstringToStdString(s1) + jh::jstringToStdString(s2));
 *
+* // Several references can survive the pop too:
+* frame.push();
+* jstring s3 = jh::createJString("s3");
+* jobject o = jh::createNewObject<JavaExample>();
+* frame.popKeeping(&s3, &o);
+*
+* // Reserve room for many local references before creating them:
+* if (jh::ensureLocalCapacity(1000)) {
+*     ...
+* }
+*
+* // Process a lot of objects in frames of 64 references each:
+* jh::forEachInLocalFrames(count, [&](int i) {
+*     jh::callMethod<void>(objects, "process", jh::createJString(names[i]));
+* });
+*
+* // Visit the elements of a large object array the same way:
+* jh::forEachArrayElement(exampleArray, [](jobject element, int index) {
+*     jh::callMethod<void>(element, "update", index);
+* });
+*
 * @endcode
 */
 #include "_android/utils/LocalReferenceFrame.hpp"
@@ -299,6 +565,51 @@
 */
 #include "_android/utils/JavaObjectPointer.hpp"
 
+/**
+* ==================== JAVA REFERENCES ====================
+* @code{.cpp}
+*
+* // Typed owning references; moves never call JNI, null checks are pointer tests:
+* jh::LocalRef<Example> local(jh::createNewObject<Example>());
+* jh::GlobalRef<Example> global(local);
+* jh::WeakRef<Example> weak(global);
+*
+* // Can be used as arguments of java calls:
+* jh::callMethod<void, Example>(global, "someMethod", local);
+*
+* // Weak reference is promoted to a global one:
+* if (auto strong = weak.lock())
+*     jh::callMethod<void>(strong, "stillAlive");
+*
+* @endcode
+*/
+#include "_android/utils/JavaReferences.hpp"
+
+/**
+* ==================== SHARED JAVA OBJECT ====================
+* @code{.cpp}
+*
+* // One global reference, copies only touch an atomic counter:
+* jh::SharedJavaObject shared(jh::createNewObject<Example>());
+* tasks.push([shared] { ... });
+*
+* @endcode
+*/
+#include "_android/utils/SharedJavaObject.hpp"
+
+/**
+* ==================== DEFERRED RELEASES ====================
+* @code{.cpp}
+*
+* // Global references owned by library classes can be dropped in threads without
+* // JNIEnv; they are queued and deleted later by attached threads:
+* jh::configureDeferredReleases(64, std::chrono::milliseconds(100));
+* jh::flushDeferredReleases();
+*
+* @endcode
+*/
+#include "_android/utils/DeferredRelease.hpp"
+
 /**
 * ==================== JAVA STRING ====================
 * @code{.cpp}
@@ -309,8 +620,34 @@
 * // Transforming java string to std::string:
 * std::string ss = jh::jstringToStdString(js);
 *
+* // Both work with standard UTF-8; raw transcoding is also available:
+* std::size_t length = jh::utf8ToUtf16(text.data(), text.size(), utf16Buffer);
+*
+* // Converting many java strings without allocations:
+* std::string buffer;
+* jh::jstringToBuffer(js, buffer);
+*
+* // Comparing java string with UTF-8 text without copying (no JNI calls while the view is alive):
+* bool same = jh::JStringView(js).equals("someText");
+*
 * @endcode
 */
 #include "_android/utils/JStringUtils.hpp"
+#include "_android/utils/JStringView.hpp"
+
+/**
+* ==================== INTERNED JAVA STRINGS ====================
+* @code{.cpp}
+*
+* // String literal; java string is created once per call site (don't delete it!):
+* jh::callMethod<void, jstring>(someObject, "put", JH_INTERNED_JSTRING("some-constant-key"));
+*
+* // Dynamic text; cached in the bounded LRU cache:
+* jstring key = jh::internedJString(keyName);
+* log(jh::internedJStringStatistics().hitRate());
+*
+* @endcode
+*/
+#include "_android/utils/InternedJString.hpp"
 
 #endif
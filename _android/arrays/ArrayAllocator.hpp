@@ -10,6 +10,7 @@
 
 #include <jni.h>
 #include "../core/ErrorHandler.hpp"
+#include "../core/Statistics.hpp"
 
 namespace jh
 {
@@ -27,10 +28,50 @@ namespace jh
     {
         static jbooleanArray create(JNIEnv* env, jsize size)
         {
+            countStatistic(Statistic::ArraysCreated);
             return env->NewBooleanArray(size);
         }
     };
 
+    /**
+    * Implementation of java byte array creation.
+    */
+    template<class ElementType>
+    struct JavaArrayAllocator<jbyteArray, ElementType>
+    {
+        static jbyteArray create(JNIEnv* env, jsize size)
+        {
+            countStatistic(Statistic::ArraysCreated);
+            return env->NewByteArray(size);
+        }
+    };
+
+    /**
+    * Implementation of java char array creation.
+    */
+    template<class ElementType>
+    struct JavaArrayAllocator<jcharArray, ElementType>
+    {
+        static jcharArray create(JNIEnv* env, jsize size)
+        {
+            countStatistic(Statistic::ArraysCreated);
+            return env->NewCharArray(size);
+        }
+    };
+
+    /**
+    * Implementation of java short array creation.
+    */
+    template<class ElementType>
+    struct JavaArrayAllocator<jshortArray, ElementType>
+    {
+        static jshortArray create(JNIEnv* env, jsize size)
+        {
+            countStatistic(Statistic::ArraysCreated);
+            return env->NewShortArray(size);
+        }
+    };
+
     /**
     * Implementation of java int array creation.
     */
@@ -39,6 +80,7 @@ namespace jh
     {
         static jintArray create(JNIEnv* env, jsize size)
         {
+            countStatistic(Statistic::ArraysCreated);
             return env->NewIntArray(size);
         }
     };
@@ -51,6 +93,7 @@ namespace jh
     {
         static jlongArray create(JNIEnv* env, jsize size)
         {
+            countStatistic(Statistic::ArraysCreated);
             return env->NewLongArray(size);
         }
     };
@@ -63,6 +106,7 @@ namespace jh
     {
         static jfloatArray create(JNIEnv* env, jsize size)
         {
+            countStatistic(Statistic::ArraysCreated);
             return env->NewFloatArray(size);
         }
     };
@@ -75,6 +119,7 @@ namespace jh
     {
         static jdoubleArray create(JNIEnv* env, jsize size)
         {
+            countStatistic(Statistic::ArraysCreated);
             return env->NewDoubleArray(size);
         }
     };
@@ -91,13 +136,20 @@ namespace jh
         {
             std::string className = ToJavaType<ElementType>::className();
 
+            countStatistic(Statistic::ClassLookups);
+
             jclass javaClass = env->FindClass(className.c_str());
             if (javaClass == nullptr) {
                 reportInternalError("class not found [" + className + "]");
                 return nullptr;
             }
 
-            return env->NewObjectArray(size, javaClass, nullptr);
+            jobjectArray array = env->NewObjectArray(size, javaClass, nullptr);
+            env->DeleteLocalRef(javaClass);
+
+            countStatistic(Statistic::ArraysCreated);
+
+            return array;
         }
     };
 }
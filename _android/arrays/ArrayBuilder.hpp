@@ -21,7 +21,10 @@
 *     .add(v.begin(), v.end())  // iterators
 *     .build());
 *
-* // Create jstring array:
+* // Create byte array (also int16_t for short[] and char16_t for char[]):
+* jbyteArray byteArray = jh::JavaArrayBuilder<int8_t>().add({1, 2, 3}).build();
+*
+* // Create jstring array (see also jh::toJavaStringArray for many strings):
 * jobjectArray stringArray = jh::JavaArrayBuilder<jstring>()
 *     .add(jh::createJString("someString"))
 *     .build();
@@ -37,6 +40,11 @@
 *     cout << i << endl;
 * }
 *
+* // Visit the elements of a large object array without keeping all of them alive:
+* jh::forEachArrayElement(exampleArray, [](jobject element, int index) {
+*     jh::callMethod<void>(element, "update", index);
+* });
+*
 * // Passing java array to java code:
 * jh::callMethod<void, jh::JavaArray<JavaExample>>(exampleObject, "someMethod", exampleArray);
 *
@@ -50,12 +58,14 @@
 #define JH_JAVA_ARRAYS_HPP
 
 #include <jni.h>
+#include <cstdint>
 #include <vector>
 #include "../core/ToJavaType.hpp"
 #include "../core/JNIEnvironment.hpp"
 #include "../arrays/ArrayAllocator.hpp"
 #include "../arrays/ArrayGetter.hpp"
 #include "../arrays/ArraySetter.hpp"
+#include "../utils/LocalReferenceFrame.hpp"
 
 namespace jh
 {
@@ -66,12 +76,40 @@ namespace jh
     * @param array The pointer to the specified array type instance.
     *
     * @return std::vector with the cope of all elements from the java array.
+    *
+    * @warning Every element of the object array becomes a local reference. If the VM can't
+    * reserve that many references for the whole array, the error is reported and the returned
+    * vector is empty, just like for an empty array. Object arrays of unknown (possibly large)
+    * size should be processed with jh::forEachArrayElement instead.
     */
     template<class JavaArrayType>
     std::vector<typename ToJavaType<JavaArrayType>::ElementType> jarrayToVector(JavaArrayType array)
     {
         auto env = getCurrentJNIEnvironment();
-        return std::move(JavaArrayGetter<JavaArrayType>::get(env, array));
+        return JavaArrayGetter<JavaArrayType>::get(env, array);
+    }
+
+    /**
+    * Calls the function for every element of the java object array. Elements are
+    * fetched one by one and their local references (as well as the references created
+    * by the function) are freed in chunks, so the array can have any size.
+    *
+    * @param array Java object array.
+    * @param function Callable with the signature 'void(jobject element, int index)'.
+    * @param chunkSize The number of elements per local frame.
+    */
+    template<class Function>
+    void forEachArrayElement(jobjectArray array, Function function, int chunkSize = 64)
+    {
+        if (array == nullptr) {
+            return;
+        }
+
+        auto env = getCurrentJNIEnvironment();
+
+        forEachInLocalFrames(env->GetArrayLength(array), [&](int index) {
+            function(env->GetObjectArrayElement(array, index), index);
+        }, chunkSize);
     }
 
     /**
@@ -173,6 +211,24 @@ namespace jh
     template<>
     class JavaArrayBuilder<bool> : public JavaBaseArrayBuilder<jbooleanArray, bool> { };
 
+    /**
+    * Java array builder for the byte array.
+    */
+    template<>
+    class JavaArrayBuilder<int8_t> : public JavaBaseArrayBuilder<jbyteArray, int8_t> { };
+
+    /**
+    * Java array builder for the char array.
+    */
+    template<>
+    class JavaArrayBuilder<char16_t> : public JavaBaseArrayBuilder<jcharArray, char16_t> { };
+
+    /**
+    * Java array builder for the short array.
+    */
+    template<>
+    class JavaArrayBuilder<int16_t> : public JavaBaseArrayBuilder<jshortArray, int16_t> { };
+
     /**
     * Java array builder for the int array.
     */
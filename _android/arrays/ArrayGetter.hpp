@@ -8,8 +8,11 @@
 #ifndef JH_ARRAY_GETTER_HPP
 #define JH_ARRAY_GETTER_HPP
 
+#include <string>
 #include <vector>
 #include <jni.h>
+#include "../core/ErrorHandler.hpp"
+#include "../core/Statistics.hpp"
 
 namespace jh
 {
@@ -29,6 +32,7 @@ namespace jh
         {
             jint size = env->GetArrayLength(array);
             jboolean* elements = env->GetBooleanArrayElements(array, nullptr);
+            countStatistic(Statistic::BytesFromJava, static_cast<std::int64_t>(size) * sizeof(*elements));
 
             std::vector<jboolean> result(static_cast<std::size_t>(size));
             for (int i = 0; i < size; ++i) {
@@ -37,7 +41,76 @@ namespace jh
 
             env->ReleaseBooleanArrayElements(array, elements, JNI_ABORT);
 
-            return std::move(result);
+            return result;
+        }
+    };
+
+    /**
+    * Implementations for getting elements from java byte arrays.
+    */
+    template<>
+    struct JavaArrayGetter<jbyteArray>
+    {
+        static std::vector<jbyte> get(JNIEnv* env, jbyteArray array)
+        {
+            jint size = env->GetArrayLength(array);
+            jbyte* elements = env->GetByteArrayElements(array, nullptr);
+            countStatistic(Statistic::BytesFromJava, static_cast<std::int64_t>(size) * sizeof(*elements));
+
+            std::vector<jbyte> result(static_cast<std::size_t>(size));
+            for (int i = 0; i < size; ++i) {
+                result[i] = elements[i];
+            }
+
+            env->ReleaseByteArrayElements(array, elements, JNI_ABORT);
+
+            return result;
+        }
+    };
+
+    /**
+    * Implementations for getting elements from java char arrays.
+    */
+    template<>
+    struct JavaArrayGetter<jcharArray>
+    {
+        static std::vector<jchar> get(JNIEnv* env, jcharArray array)
+        {
+            jint size = env->GetArrayLength(array);
+            jchar* elements = env->GetCharArrayElements(array, nullptr);
+            countStatistic(Statistic::BytesFromJava, static_cast<std::int64_t>(size) * sizeof(*elements));
+
+            std::vector<jchar> result(static_cast<std::size_t>(size));
+            for (int i = 0; i < size; ++i) {
+                result[i] = elements[i];
+            }
+
+            env->ReleaseCharArrayElements(array, elements, JNI_ABORT);
+
+            return result;
+        }
+    };
+
+    /**
+    * Implementations for getting elements from java short arrays.
+    */
+    template<>
+    struct JavaArrayGetter<jshortArray>
+    {
+        static std::vector<jshort> get(JNIEnv* env, jshortArray array)
+        {
+            jint size = env->GetArrayLength(array);
+            jshort* elements = env->GetShortArrayElements(array, nullptr);
+            countStatistic(Statistic::BytesFromJava, static_cast<std::int64_t>(size) * sizeof(*elements));
+
+            std::vector<jshort> result(static_cast<std::size_t>(size));
+            for (int i = 0; i < size; ++i) {
+                result[i] = elements[i];
+            }
+
+            env->ReleaseShortArrayElements(array, elements, JNI_ABORT);
+
+            return result;
         }
     };
 
@@ -51,6 +124,7 @@ namespace jh
         {
             jint size = env->GetArrayLength(array);
             jint* elements = env->GetIntArrayElements(array, nullptr);
+            countStatistic(Statistic::BytesFromJava, static_cast<std::int64_t>(size) * sizeof(*elements));
 
             std::vector<jint> result(static_cast<std::size_t>(size));
             for (int i = 0; i < size; ++i) {
@@ -59,7 +133,7 @@ namespace jh
 
             env->ReleaseIntArrayElements(array, elements, JNI_ABORT);
 
-            return std::move(result);
+            return result;
         }
     };
 
@@ -73,6 +147,7 @@ namespace jh
         {
             jint size = env->GetArrayLength(array);
             jlong* elements = env->GetLongArrayElements(array, nullptr);
+            countStatistic(Statistic::BytesFromJava, static_cast<std::int64_t>(size) * sizeof(*elements));
 
             std::vector<jlong> result(static_cast<std::size_t>(size));
             for (int i = 0; i < size; ++i) {
@@ -81,7 +156,7 @@ namespace jh
 
             env->ReleaseLongArrayElements(array, elements, JNI_ABORT);
 
-            return std::move(result);
+            return result;
         }
     };
 
@@ -95,6 +170,7 @@ namespace jh
         {
             jint size = env->GetArrayLength(array);
             jfloat* elements = env->GetFloatArrayElements(array, nullptr);
+            countStatistic(Statistic::BytesFromJava, static_cast<std::int64_t>(size) * sizeof(*elements));
 
             std::vector<jfloat> result(static_cast<std::size_t>(size));
             for (int i = 0; i < size; ++i) {
@@ -103,7 +179,7 @@ namespace jh
 
             env->ReleaseFloatArrayElements(array, elements, JNI_ABORT);
 
-            return std::move(result);
+            return result;
         }
     };
 
@@ -117,6 +193,7 @@ namespace jh
         {
             jint size = env->GetArrayLength(array);
             jdouble* elements = env->GetDoubleArrayElements(array, nullptr);
+            countStatistic(Statistic::BytesFromJava, static_cast<std::int64_t>(size) * sizeof(*elements));
 
             std::vector<jdouble> result(static_cast<std::size_t>(size));
             for (int i = 0; i < size; ++i) {
@@ -125,7 +202,7 @@ namespace jh
 
             env->ReleaseDoubleArrayElements(array, elements, JNI_ABORT);
 
-            return std::move(result);
+            return result;
         }
     };
 
@@ -139,12 +216,19 @@ namespace jh
         {
             jint size = env->GetArrayLength(array);
 
+            // every element becomes a local reference, so the table should have room for all of them
+            if (env->EnsureLocalCapacity(size) != 0) {
+                env->ExceptionClear();
+                reportInternalError("not enough local references for " + std::to_string(size) + " array elements, use jh::forEachArrayElement");
+                return std::vector<jobject>();
+            }
+
             std::vector<jobject> result(static_cast<std::size_t>(size));
             for (int i = 0; i < size; ++i) {
                 result[i] = env->GetObjectArrayElement(array, i);
             }
 
-            return std::move(result);
+            return result;
         }
     };
 }
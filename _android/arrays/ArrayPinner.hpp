@@ -0,0 +1,272 @@
+/**
+    \file ArrayPinner.hpp
+    \brief Internal implementation of direct access to java primitive array elements.
+    \author Denis Sorokin
+    \date 01.03.2016
+*/
+
+#ifndef JH_ARRAY_PINNER_HPP
+#define JH_ARRAY_PINNER_HPP
+
+#include <jni.h>
+
+namespace jh
+{
+    /**
+    * The way the elements of java primitive array are exposed to the native code.
+    *
+    * Critical - GetPrimitiveArrayCritical; no JNI calls (and no blocking) are allowed until the release.
+    * Elements - Get<Type>ArrayElements; JNI calls are allowed, but the VM is free to return a copy.
+    */
+    enum class ArrayPinMode
+    {
+        Critical,
+        Elements
+    };
+
+    /**
+    * Stub implementation of pinning java arrays.
+    */
+    template<class JavaArrayType>
+    struct JavaArrayPinner;
+
+    /**
+    * Common part of all primitive array pinners.
+    *
+    * @param JavaArrayType Type of java primitive array.
+    * @param JavaElementType Type of the elements inside this array.
+    */
+    template<class JavaArrayType, class JavaElementType>
+    struct JavaBaseArrayPinner
+    {
+        using ElementType = JavaElementType;
+
+        /**
+        * Returns the pointer to the array elements or nullptr if the VM refused to pin them.
+        */
+        static ElementType* pin(JNIEnv* env, JavaArrayType array, ArrayPinMode mode)
+        {
+            if (mode == ArrayPinMode::Critical) {
+                return static_cast<ElementType*>(env->GetPrimitiveArrayCritical(array, nullptr));
+            }
+
+            return JavaArrayPinner<JavaArrayType>::getElements(env, array);
+        }
+
+        /**
+        * Releases the elements returned by 'pin'.
+        *
+        * @param releaseMode 0 to copy back and free, JNI_COMMIT to copy back only, JNI_ABORT to free only.
+        */
+        static void release(JNIEnv* env, JavaArrayType array, ElementType* elements, ArrayPinMode mode, jint releaseMode)
+        {
+            if (mode == ArrayPinMode::Critical) {
+                env->ReleasePrimitiveArrayCritical(array, elements, releaseMode);
+            } else {
+                JavaArrayPinner<JavaArrayType>::releaseElements(env, array, elements, releaseMode);
+            }
+        }
+    };
+
+    /**
+    * Implementation of pinning java boolean arrays.
+    */
+    template<>
+    struct JavaArrayPinner<jbooleanArray> : public JavaBaseArrayPinner<jbooleanArray, jboolean>
+    {
+        static jboolean* getElements(JNIEnv* env, jbooleanArray array)
+        {
+            return env->GetBooleanArrayElements(array, nullptr);
+        }
+
+        static void releaseElements(JNIEnv* env, jbooleanArray array, jboolean* elements, jint releaseMode)
+        {
+            env->ReleaseBooleanArrayElements(array, elements, releaseMode);
+        }
+    };
+
+    /**
+    * Implementation of pinning java byte arrays.
+    */
+    template<>
+    struct JavaArrayPinner<jbyteArray> : public JavaBaseArrayPinner<jbyteArray, jbyte>
+    {
+        static jbyte* getElements(JNIEnv* env, jbyteArray array)
+        {
+            return env->GetByteArrayElements(array, nullptr);
+        }
+
+        static void releaseElements(JNIEnv* env, jbyteArray array, jbyte* elements, jint releaseMode)
+        {
+            env->ReleaseByteArrayElements(array, elements, releaseMode);
+        }
+    };
+
+    /**
+    * Implementation of pinning java char arrays.
+    */
+    template<>
+    struct JavaArrayPinner<jcharArray> : public JavaBaseArrayPinner<jcharArray, jchar>
+    {
+        static jchar* getElements(JNIEnv* env, jcharArray array)
+        {
+            return env->GetCharArrayElements(array, nullptr);
+        }
+
+        static void releaseElements(JNIEnv* env, jcharArray array, jchar* elements, jint releaseMode)
+        {
+            env->ReleaseCharArrayElements(array, elements, releaseMode);
+        }
+    };
+
+    /**
+    * Implementation of pinning java short arrays.
+    */
+    template<>
+    struct JavaArrayPinner<jshortArray> : public JavaBaseArrayPinner<jshortArray, jshort>
+    {
+        static jshort* getElements(JNIEnv* env, jshortArray array)
+        {
+            return env->GetShortArrayElements(array, nullptr);
+        }
+
+        static void releaseElements(JNIEnv* env, jshortArray array, jshort* elements, jint releaseMode)
+        {
+            env->ReleaseShortArrayElements(array, elements, releaseMode);
+        }
+    };
+
+    /**
+    * Implementation of pinning java int arrays.
+    */
+    template<>
+    struct JavaArrayPinner<jintArray> : public JavaBaseArrayPinner<jintArray, jint>
+    {
+        static jint* getElements(JNIEnv* env, jintArray array)
+        {
+            return env->GetIntArrayElements(array, nullptr);
+        }
+
+        static void releaseElements(JNIEnv* env, jintArray array, jint* elements, jint releaseMode)
+        {
+            env->ReleaseIntArrayElements(array, elements, releaseMode);
+        }
+    };
+
+    /**
+    * Implementation of pinning java long arrays.
+    */
+    template<>
+    struct JavaArrayPinner<jlongArray> : public JavaBaseArrayPinner<jlongArray, jlong>
+    {
+        static jlong* getElements(JNIEnv* env, jlongArray array)
+        {
+            return env->GetLongArrayElements(array, nullptr);
+        }
+
+        static void releaseElements(JNIEnv* env, jlongArray array, jlong* elements, jint releaseMode)
+        {
+            env->ReleaseLongArrayElements(array, elements, releaseMode);
+        }
+    };
+
+    /**
+    * Implementation of pinning java float arrays.
+    */
+    template<>
+    struct JavaArrayPinner<jfloatArray> : public JavaBaseArrayPinner<jfloatArray, jfloat>
+    {
+        static jfloat* getElements(JNIEnv* env, jfloatArray array)
+        {
+            return env->GetFloatArrayElements(array, nullptr);
+        }
+
+        static void releaseElements(JNIEnv* env, jfloatArray array, jfloat* elements, jint releaseMode)
+        {
+            env->ReleaseFloatArrayElements(array, elements, releaseMode);
+        }
+    };
+
+    /**
+    * Implementation of pinning java double arrays.
+    */
+    template<>
+    struct JavaArrayPinner<jdoubleArray> : public JavaBaseArrayPinner<jdoubleArray, jdouble>
+    {
+        static jdouble* getElements(JNIEnv* env, jdoubleArray array)
+        {
+            return env->GetDoubleArrayElements(array, nullptr);
+        }
+
+        static void releaseElements(JNIEnv* env, jdoubleArray array, jdouble* elements, jint releaseMode)
+        {
+            env->ReleaseDoubleArrayElements(array, elements, releaseMode);
+        }
+    };
+
+    /**
+    * Pins the java primitive array for the lifetime of the object. The elements are
+    * committed back to java by 'commit'; if the object is destroyed without the commit
+    * (for example, by an exception) the changes are dropped with JNI_ABORT, so a critical
+    * section never stays open.
+    */
+    template<class JavaArrayType>
+    class PinnedJavaArray
+    {
+    public:
+        using Pinner = JavaArrayPinner<JavaArrayType>;
+        using ElementType = typename Pinner::ElementType;
+
+        PinnedJavaArray(JNIEnv* env, JavaArrayType array, ArrayPinMode mode)
+        : m_env(env)
+        , m_array(array)
+        , m_mode(mode)
+        , m_elements(Pinner::pin(env, array, mode))
+        {
+            // nothing to do here
+        }
+
+        ~PinnedJavaArray()
+        {
+            release(JNI_ABORT);
+        }
+
+        /**
+        * Copies the changes back to java and releases the elements.
+        */
+        void commit()
+        {
+            release(0);
+        }
+
+        /**
+        * Returns the pinned elements or nullptr if the VM refused to pin them.
+        */
+        ElementType* elements() const
+        {
+            return m_elements;
+        }
+
+    private:
+        JNIEnv* m_env;
+        JavaArrayType m_array;
+        ArrayPinMode m_mode;
+        ElementType* m_elements;
+
+        void release(jint releaseMode)
+        {
+            if (m_elements) {
+                Pinner::release(m_env, m_array, m_elements, m_mode, releaseMode);
+                m_elements = nullptr;
+            }
+        }
+
+        /**
+        * Pinned array should not be copied.
+        */
+        PinnedJavaArray(const PinnedJavaArray &) = delete;
+        void operator=(const PinnedJavaArray &) = delete;
+    };
+}
+
+#endif
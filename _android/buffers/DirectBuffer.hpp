@@ -0,0 +1,199 @@
+/**
+    \file DirectBuffer.hpp
+    \brief Sharing native memory with java code through direct byte buffers.
+    \author Denis Sorokin
+    \date 04.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // Wrap native memory that is owned by somebody else (no copy):
+* jh::DirectBuffer frame(pixels, width * height * 4);
+*
+* // Wrap native memory and take the ownership of it:
+* std::unique_ptr<uint8_t[]> memory(new uint8_t[1024]);
+* jh::DirectBuffer owned(std::move(memory), 1024);
+*
+* // Allocate new native memory and wrap it:
+* jh::DirectBuffer allocated(4096);
+*
+* // Pass it to java as 'java.nio.ByteBuffer':
+* jh::callMethod<void, jh::DirectBuffer>(someObject, "onFrame", frame);
+*
+* // Get the direct buffer allocated by java and read it without copying:
+* jh::DirectBufferView view(jh::callMethod<jh::DirectBuffer>(someObject, "getBuffer"));
+* if (view) {
+*     process(view.data(), view.size());
+* }
+*
+* @endcode
+*/
+
+#ifndef JH_DIRECT_BUFFER_HPP
+#define JH_DIRECT_BUFFER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <jni.h>
+#include "../utils/JavaObjectPointer.hpp"
+
+namespace jh
+{
+    /**
+    * Native memory exposed to java as a direct 'java.nio.ByteBuffer'. Java code reads
+    * and writes this memory directly, nothing is copied across the JNI boundary.
+    * Can be used as 'jh::DirectBuffer' type in the java calls and native methods.
+    *
+    * @warning The native memory is freed on reset or destruction no matter how many references
+    * to the byte buffer java still holds, and any access through them is a use-after-free. The owner
+    * must make sure java has dropped every reference to the buffer (including fields, collections and
+    * duplicated or sliced buffers) before resetting or destroying the DirectBuffer object.
+    */
+    class DirectBuffer
+    {
+    public:
+        /**
+        * Function that frees the wrapped native memory.
+        */
+        using Deleter = std::function<void(void*)>;
+
+        /**
+        * Java class of the wrapped object.
+        */
+        static std::string className()
+        {
+            return "java/nio/ByteBuffer";
+        }
+
+        /**
+        * Java signature of the wrapped object.
+        */
+        static std::string signature()
+        {
+            return "L" + className() + ";";
+        }
+
+        /**
+        * Creates an empty buffer.
+        */
+        DirectBuffer();
+
+        /**
+        * Allocates 'size' bytes of native memory and wraps them.
+        */
+        explicit DirectBuffer(std::size_t size);
+
+        /**
+        * Wraps native memory that is owned by someone else.
+        *
+        * @param data Pointer to the native memory.
+        * @param size Size of the native memory in bytes.
+        */
+        DirectBuffer(void* data, std::size_t size);
+
+        /**
+        * Wraps native memory and takes the ownership of it.
+        *
+        * @param data Pointer to the native memory.
+        * @param size Size of the native memory in bytes.
+        * @param deleter Function that frees the memory after the buffer destruction.
+        */
+        DirectBuffer(void* data, std::size_t size, Deleter deleter);
+
+        /**
+        * Wraps native memory owned by the unique pointer and takes the ownership of it.
+        *
+        * @param memory Unique pointer to the native memory.
+        * @param size Size of the native memory in bytes.
+        */
+        template<class ElementType, class ElementDeleter>
+        DirectBuffer(std::unique_ptr<ElementType, ElementDeleter> memory, std::size_t size)
+        : DirectBuffer()
+        {
+            using Pointer = typename std::unique_ptr<ElementType, ElementDeleter>::pointer;
+
+            ElementDeleter deleter = memory.get_deleter();
+            Pointer pointer = memory.release();
+
+            wrap(pointer, size, [deleter] (void* data) mutable {
+                deleter(static_cast<Pointer>(data));
+            });
+        }
+
+        DirectBuffer(DirectBuffer&& other);
+        DirectBuffer& operator=(DirectBuffer&& other);
+        ~DirectBuffer();
+
+        /**
+        * Releases the java byte buffer and frees the native memory if it is owned.
+        * Java must not hold any references to the buffer at this point.
+        */
+        void reset();
+
+        void* data() const;
+        std::size_t size() const;
+
+        /**
+        * Returns the java byte buffer object.
+        */
+        jobject object() const;
+
+        operator jobject() const;
+        explicit operator bool() const;
+
+    private:
+        void wrap(void* data, std::size_t size, Deleter deleter);
+
+        void* m_data;
+        std::size_t m_size;
+        Deleter m_deleter;
+        JavaObjectPointer m_byteBuffer;
+
+        /**
+        * Buffer should not be copied.
+        */
+        DirectBuffer(const DirectBuffer &) = delete;
+        void operator=(const DirectBuffer &) = delete;
+    };
+
+    /**
+    * Non-owning view of the direct byte buffer that was allocated by java code
+    * (or passed from java code to the native method).
+    *
+    * @warning The view is valid only while the byte buffer object is alive.
+    */
+    class DirectBufferView
+    {
+    public:
+        /**
+        * Creates an empty view.
+        */
+        DirectBufferView();
+
+        /**
+        * Creates the view of java direct byte buffer. The view is empty if the
+        * object is not a direct buffer.
+        *
+        * @param byteBuffer Java direct byte buffer.
+        */
+        explicit DirectBufferView(jobject byteBuffer);
+
+        void* data() const;
+        std::size_t size() const;
+        jobject object() const;
+
+        explicit operator bool() const;
+
+    private:
+        jobject m_byteBuffer;
+        void* m_data;
+        std::size_t m_size;
+    };
+}
+
+#endif
@@ -0,0 +1,176 @@
+/**
+    \file SharedRingBuffer.hpp
+    \brief Lock-free ring buffer shared between C++ producers and java consumer.
+    \author Denis Sorokin
+    \date 09.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // 1 MB ring written by several C++ threads:
+* static jh::SharedRingBuffer telemetry(1024 * 1024, jh::RingProducers::Multiple);
+*
+* // Hand the java reader ('com.jnihelper.SharedRingBuffer') to java code once:
+* jh::callMethod<void, jh::SharedRingBuffer>(someObject, "setTelemetry", telemetry);
+*
+* // Publish variable-size records (no JNI calls here); false means the ring is full and the record
+* // can be published again after java drains it:
+* telemetry.publish(message.data(), message.size());
+*
+* // Multiple producers reserve space without locks, but records become visible in the reservation
+* // order: a producer yields until the earlier ones have copied their records, so a producer that
+* // is preempted in the middle of 'publish' delays the others (single producer never waits).
+*
+* // Publish fixed-size records:
+* Event event = { ... };
+* telemetry.publish(event);
+*
+* // Once per batch - wakes the java consumer up if it is waiting (at most one java call):
+* telemetry.notifyConsumer();
+*
+* @endcode
+*
+* @code{.java}
+*
+* // Java side drains records in batches:
+* while (running) {
+*     reader.await(100);
+*     reader.drain((buffer, offset, length) -> handle(buffer, offset, length));
+* }
+*
+* @endcode
+*/
+
+#ifndef JH_SHARED_RING_BUFFER_HPP
+#define JH_SHARED_RING_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <jni.h>
+#include "../buffers/DirectBuffer.hpp"
+#include "../utils/JavaObjectPointer.hpp"
+
+namespace jh
+{
+    /**
+    * Number of threads that are allowed to publish records at the same time.
+    */
+    enum class RingProducers
+    {
+        Single,
+        Multiple
+    };
+
+    /**
+    * Ring buffer laid out in a direct byte buffer. C++ producers publish records with
+    * release semantics, the java reader (com.jnihelper.SharedRingBuffer, shipped in the
+    * '_java' folder) drains them in batches with two JNI calls per batch.
+    *
+    * Head, tail and reservation counters live on separate cache lines. Every record is
+    * a 32-bit length followed by the payload and aligned to 8 bytes; records never wrap
+    * around the end of the ring.
+    *
+    * Can be used as 'jh::SharedRingBuffer' argument in the java calls; the java
+    * reader object is passed in this case.
+    *
+    * @warning Java code should not use the reader after the ring is destroyed.
+    */
+    class SharedRingBuffer
+    {
+    public:
+        /**
+        * Java class of the reader object.
+        */
+        static std::string className()
+        {
+            return "com/jnihelper/SharedRingBuffer";
+        }
+
+        /**
+        * Java signature of the reader object.
+        */
+        static std::string signature()
+        {
+            return "L" + className() + ";";
+        }
+
+        /**
+        * Creates the ring and its java reader.
+        *
+        * @param capacity Size of the data area in bytes; rounded up to the power of two.
+        * @param producers Whether several threads are going to publish at the same time.
+        */
+        explicit SharedRingBuffer(std::size_t capacity, RingProducers producers = RingProducers::Single);
+
+        /**
+        * Copies the record into the ring and publishes it.
+        *
+        * @param data Record payload.
+        * @param size Payload size in bytes.
+        * @return True if the record was published, false if there is not enough free space.
+        *
+        * @warning Records never wrap, so a record that doesn't fit before the end of the ring
+        * only moves the producers to its beginning and false is returned; the same record
+        * is published after the consumer drains the ring. Records larger than the capacity
+        * are never published.
+        */
+        bool publish(const void* data, std::size_t size);
+
+        /**
+        * Publishes the fixed-size record.
+        */
+        template<class Record>
+        bool publish(const Record& record)
+        {
+            static_assert(std::is_trivially_copyable<Record>::value, "records should be trivially copyable");
+            return publish(&record, sizeof(Record));
+        }
+
+        /**
+        * Wakes up the java consumer if it is blocked in 'await'. Should be called once per
+        * batch of records; makes a java call only when the consumer is actually waiting.
+        */
+        void notifyConsumer();
+
+        /**
+        * Number of published bytes that were not drained yet (including record headers).
+        */
+        std::size_t pendingBytes() const;
+
+        /**
+        * Size of the data area in bytes.
+        */
+        std::size_t capacity() const;
+
+        /**
+        * Returns the java reader object.
+        */
+        jobject reader() const;
+
+        operator jobject() const;
+        explicit operator bool() const;
+
+    private:
+        struct Header;
+
+        Header* m_header;
+        char* m_data;
+        std::size_t m_capacity;
+        RingProducers m_producers;
+        DirectBuffer m_buffer;
+        JavaObjectPointer m_reader;
+
+        /**
+        * Ring should not be copied.
+        */
+        SharedRingBuffer(const SharedRingBuffer &) = delete;
+        void operator=(const SharedRingBuffer &) = delete;
+    };
+}
+
+#endif
@@ -0,0 +1,90 @@
+/**
+    \file JavaCallProfiler.cpp
+    \brief Optional latency profiling of the calls from C++ to java.
+    \author Denis Sorokin
+    \date 23.03.2016
+*/
+
+#include "../calls/JavaCallProfiler.hpp"
+#include "../core/ErrorHandler.hpp"
+
+namespace jh
+{
+    namespace
+    {
+        /**
+        * Slots of the statistics are the slots of the method cache entries.
+        */
+        const std::size_t kMaxProfiledJavaMethods = 1024;
+
+        struct JavaCallLookupTag {};
+        struct JavaCallTag {};
+
+        using JavaCallLookupStats = ShardedLatencyStats<JavaCallLookupTag, kMaxProfiledJavaMethods>;
+        using JavaCallStats = ShardedLatencyStats<JavaCallTag, kMaxProfiledJavaMethods>;
+
+        std::atomic<std::uint64_t> slowCallThreshold(0);
+        std::atomic<std::uint64_t> slowCallLogInterval(100000000);
+        std::atomic<std::uint64_t> nextSlowCallLog(0);
+        std::atomic<bool> slotsExhaustedReported(false);
+
+        /**
+        * Logs the slow call unless another one was logged less than the log interval ago.
+        */
+        void reportSlowCall(const JavaMethodEntry* method, std::uint64_t callNanoseconds)
+        {
+            std::uint64_t now = latency::nowNanoseconds();
+            std::uint64_t allowed = nextSlowCallLog.load(std::memory_order_relaxed);
+
+            if (now < allowed) {
+                return;
+            }
+
+            std::uint64_t next = now + slowCallLogInterval.load(std::memory_order_relaxed);
+            if (!nextSlowCallLog.compare_exchange_strong(allowed, next, std::memory_order_relaxed)) {
+                return;
+            }
+
+            reportInternalInfo("slow java call [" + method->className + "." + method->methodName + method->signature
+                + "] took " + std::to_string(callNanoseconds / 1000) + " us");
+        }
+    }
+
+    void setSlowJavaCallThreshold(std::uint64_t nanoseconds, unsigned maxLogsPerSecond)
+    {
+        slowCallThreshold.store(nanoseconds, std::memory_order_relaxed);
+        slowCallLogInterval.store(maxLogsPerSecond > 0 ? 1000000000ull / maxLogsPerSecond : 1000000000ull, std::memory_order_relaxed);
+    }
+
+    void recordJavaCall(const JavaMethodEntry* method, std::uint64_t lookupNanoseconds, std::uint64_t callNanoseconds)
+    {
+        if (method->slot >= kMaxProfiledJavaMethods && !slotsExhaustedReported.exchange(true, std::memory_order_relaxed)) {
+            reportInternalError("java call profiler is full: calls of the methods after the first "
+                + std::to_string(kMaxProfiledJavaMethods - 1) + " cached ones are not profiled");
+        }
+
+        JavaCallLookupStats::record(method->slot, lookupNanoseconds);
+        JavaCallStats::record(method->slot, callNanoseconds);
+
+        std::uint64_t threshold = slowCallThreshold.load(std::memory_order_relaxed);
+        if (threshold > 0 && callNanoseconds >= threshold) {
+            reportSlowCall(method, callNanoseconds);
+        }
+    }
+
+    std::vector<JavaCallProfile> javaCallProfiles()
+    {
+        std::vector<JavaCallProfile> profiles;
+
+        for (const JavaMethodEntry* method : cachedJavaMethods()) {
+            LatencySummary call = JavaCallStats::collect(method->slot);
+            if (call.calls == 0) {
+                continue;
+            }
+
+            profiles.push_back({method->className, method->methodName, method->signature, JavaCallLookupStats::collect(method->slot), call});
+        }
+
+        return profiles;
+    }
+}
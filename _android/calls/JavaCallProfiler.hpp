@@ -0,0 +1,141 @@
+/**
+    \file JavaCallProfiler.hpp
+    \brief Optional latency profiling of the calls from C++ to java.
+    \author Denis Sorokin
+    \date 23.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // Profiling is off by default and can be switched at any time:
+* jh::setJavaCallProfilingEnabled(true);
+*
+* // Calls slower than 5 ms are logged, but no more than 10 times per second:
+* jh::setSlowJavaCallThreshold(5000000, 10);
+*
+* // Statistics of callMethod, callStaticMethod and createNewObject per java method:
+* for (const jh::JavaCallProfile& profile : jh::javaCallProfiles())
+*     log(profile.className + "." + profile.methodName, profile.call.calls, profile.lookup.p50Nanoseconds, profile.call.p99Nanoseconds);
+*
+* @endcode
+*/
+
+#ifndef JH_JAVA_CALL_PROFILER_HPP
+#define JH_JAVA_CALL_PROFILER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../calls/JavaMethodCache.hpp"
+#include "../utils/LatencyStats.hpp"
+
+namespace jh
+{
+    /**
+    * Profile of one java method.
+    *
+    * @param lookup Time spent to find the class and the method (mostly the method cache lookup).
+    * @param call Time spent in the java call itself.
+    */
+    struct JavaCallProfile
+    {
+        std::string className;
+        std::string methodName;
+        std::string signature;
+        LatencySummary lookup;
+        LatencySummary call;
+    };
+
+    /**
+    * Flag of the profiling; checked by every call, so it is a plain atomic.
+    */
+    inline std::atomic<bool>& javaCallProfilingFlag()
+    {
+        static std::atomic<bool> flag(false);
+        return flag;
+    }
+
+    inline void setJavaCallProfilingEnabled(bool enabled)
+    {
+        javaCallProfilingFlag().store(enabled, std::memory_order_relaxed);
+    }
+
+    inline bool javaCallProfilingEnabled()
+    {
+        return javaCallProfilingFlag().load(std::memory_order_relaxed);
+    }
+
+    /**
+    * Sets the duration of the java call that is logged as slow; only works while the profiling is enabled.
+    *
+    * @param nanoseconds Threshold of the java call itself (without the lookup); 0 disables the logging.
+    * @param maxLogsPerSecond Limit of the slow call messages.
+    */
+    void setSlowJavaCallThreshold(std::uint64_t nanoseconds, unsigned maxLogsPerSecond = 10);
+
+    /**
+    * Merges the statistics of all threads.
+    *
+    * @return Profiles of the methods that were called while the profiling was enabled.
+    */
+    std::vector<JavaCallProfile> javaCallProfiles();
+
+    /**
+    * Records the profiled call. It should not be used by the programmer itself.
+    */
+    void recordJavaCall(const JavaMethodEntry* method, std::uint64_t lookupNanoseconds, std::uint64_t callNanoseconds);
+
+    /**
+    * Measures one java call if the profiling is enabled; the call is recorded on destruction.
+    * It should not be used by the programmer itself, but by the java call functions.
+    */
+    class JavaCallTimer
+    {
+    public:
+        JavaCallTimer()
+        : m_enabled(javaCallProfilingEnabled())
+        , m_method(nullptr)
+        , m_start(m_enabled ? latency::nowNanoseconds() : 0)
+        , m_lookupEnd(0)
+        {
+            // nothing to do here
+        }
+
+        ~JavaCallTimer()
+        {
+            if (m_method) {
+                recordJavaCall(m_method, m_lookupEnd - m_start, latency::nowNanoseconds() - m_lookupEnd);
+            }
+        }
+
+        /**
+        * Ends the lookup part of the call; calls that failed the lookup are not recorded.
+        */
+        void lookupFinished(const JavaMethodEntry* method)
+        {
+            if (m_enabled) {
+                m_method = method;
+                m_lookupEnd = latency::nowNanoseconds();
+            }
+        }
+
+    private:
+        bool m_enabled;
+        const JavaMethodEntry* m_method;
+        std::uint64_t m_start;
+        std::uint64_t m_lookupEnd;
+
+        /**
+        * Timer should not be copied.
+        */
+        JavaCallTimer(const JavaCallTimer &) = delete;
+        void operator=(const JavaCallTimer &) = delete;
+    };
+}
+
+#endif
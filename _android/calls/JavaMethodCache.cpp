@@ -0,0 +1,268 @@
+/**
+    \file JavaMethodCache.cpp
+    \brief Cache of java classes and method IDs used by the java calls.
+    \author Denis Sorokin
+    \date 23.03.2016
+*/
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include "../calls/JavaMethodCache.hpp"
+#include "../core/ErrorHandler.hpp"
+#include "../core/Statistics.hpp"
+#include "../utils/JavaReferences.hpp"
+
+namespace jh
+{
+    namespace
+    {
+        const std::size_t kShardCount = 16;
+
+        /**
+        * Entries with the same hash; every shard takes its own cache line.
+        */
+        struct alignas(64) Shard
+        {
+            std::mutex mutex;
+            std::unordered_multimap<std::size_t, JavaMethodEntry*> entries;
+        };
+
+        Shard shards[kShardCount];
+
+        const std::size_t kRecentInstanceMethods = 64;
+
+        /**
+        * Instance method that was recently called by the thread.
+        */
+        struct RecentInstanceMethod
+        {
+            std::size_t hash;
+            const JavaMethodEntry* entry;
+        };
+
+        /**
+        * Per-thread direct-mapped cache in front of the shards; a hit takes no lock and
+        * costs one IsInstanceOf call instead of GetObjectClass and a scan of the shared bucket.
+        */
+        thread_local RecentInstanceMethod recentInstanceMethods[kRecentInstanceMethods];
+
+        std::mutex entriesMutex;
+        std::vector<const JavaMethodEntry*> allEntries;
+
+        /**
+        * Instance methods are hashed without the class name, it is only known after the first lookup;
+        * the per-thread cache of recent instance methods keeps most calls away from their shared buckets.
+        */
+        std::size_t methodHash(JavaMethodKind kind, const std::string& className, const std::string& methodName, const std::string& signature)
+        {
+            std::hash<std::string> hash;
+
+            std::size_t result = static_cast<std::size_t>(kind);
+            result = result * 31 + hash(className);
+            result = result * 31 + hash(methodName);
+            result = result * 31 + hash(signature);
+
+            return result;
+        }
+
+        Shard& shard(std::size_t hash)
+        {
+            return shards[(hash >> 8) % kShardCount];
+        }
+
+        /**
+        * @return Name of the class like "com/class/path/Example".
+        */
+        std::string classNameOf(JNIEnv* env, jclass javaClass)
+        {
+            LocalRef<jclass> classClass(env->GetObjectClass(javaClass));
+
+            countStatistic(Statistic::MemberLookups);
+            jmethodID getName = env->GetMethodID(classClass, "getName", "()Ljava/lang/String;");
+            if (getName == nullptr) {
+                env->ExceptionClear();
+                return std::string();
+            }
+
+            LocalRef<jstring> name(env->CallObjectMethod(javaClass, getName));
+            if (!name) {
+                return std::string();
+            }
+
+            const char* chars = env->GetStringUTFChars(name, nullptr);
+            std::string result(chars ? chars : "");
+            if (chars) {
+                env->ReleaseStringUTFChars(name, chars);
+            }
+
+            std::replace(result.begin(), result.end(), '.', '/');
+
+            return result;
+        }
+
+        /**
+        * Adds the entry unless another thread did it first.
+        *
+        * @return The entry that is in the cache.
+        */
+        const JavaMethodEntry* insertEntry(JNIEnv* env, std::size_t hash, JavaMethodEntry* entry)
+        {
+            Shard& target = shard(hash);
+            {
+                std::lock_guard<std::mutex> lock(target.mutex);
+
+                auto range = target.entries.equal_range(hash);
+                for (auto it = range.first; it != range.second; ++it) {
+                    JavaMethodEntry* existing = it->second;
+
+                    if (existing->kind == entry->kind
+                        && existing->methodName == entry->methodName
+                        && existing->signature == entry->signature
+                        && env->IsSameObject(existing->javaClass, entry->javaClass)) {
+
+                        env->DeleteGlobalRef(entry->javaClass);
+                        delete entry;
+
+                        return existing;
+                    }
+                }
+
+                // the slot is set before other threads can see the entry
+                {
+                    std::lock_guard<std::mutex> entriesLock(entriesMutex);
+                    allEntries.push_back(entry);
+                    entry->slot = allEntries.size();
+                }
+
+                target.entries.insert(std::make_pair(hash, entry));
+            }
+
+            return entry;
+        }
+    }
+
+    const JavaMethodEntry* findJavaMethod(JNIEnv* env, JavaMethodKind kind, const std::string& className, const std::string& methodName, const std::string& signature)
+    {
+        std::size_t hash = methodHash(kind, className, methodName, signature);
+
+        {
+            Shard& target = shard(hash);
+            std::lock_guard<std::mutex> lock(target.mutex);
+
+            auto range = target.entries.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                const JavaMethodEntry* entry = it->second;
+
+                if (entry->kind == kind && entry->className == className && entry->methodName == methodName && entry->signature == signature) {
+                    countStatistic(Statistic::MethodCacheHits);
+                    return entry;
+                }
+            }
+        }
+
+        countStatistic(Statistic::MethodCacheMisses);
+        countStatistic(Statistic::ClassLookups);
+
+        LocalRef<jclass> javaClass(env->FindClass(className.c_str()));
+        if (!javaClass) {
+            reportInternalError("class not found [" + className + "]");
+            return nullptr;
+        }
+
+        countStatistic(Statistic::MemberLookups);
+
+        jmethodID method = kind == JavaMethodKind::Static
+            ? env->GetStaticMethodID(javaClass, methodName.c_str(), signature.c_str())
+            : env->GetMethodID(javaClass, methodName.c_str(), signature.c_str());
+
+        if (method == nullptr) {
+            if (kind == JavaMethodKind::Constructor) {
+                reportInternalError("constructor for class [" + className + "] not found, tried signature [" + signature + "]");
+            } else {
+                reportInternalError("method [" + methodName + "] for class [" + className + "] not found, tried signature [" + signature + "]");
+            }
+            return nullptr;
+        }
+
+        jclass globalClass = static_cast<jclass>(env->NewGlobalRef(javaClass));
+
+        return insertEntry(env, hash, new JavaMethodEntry{kind, className, methodName, signature, globalClass, method, 0});
+    }
+
+    const JavaMethodEntry* findJavaInstanceMethod(JNIEnv* env, jobject instance, const std::string& methodName, const std::string& signature)
+    {
+        static const std::string noClassName;
+
+        std::size_t hash = methodHash(JavaMethodKind::Instance, noClassName, methodName, signature);
+
+        // a subclass of the cached class is fine too: the call through its method ID is virtual
+        RecentInstanceMethod& recent = recentInstanceMethods[hash % kRecentInstanceMethods];
+        if (instance != nullptr && recent.entry != nullptr && recent.hash == hash && recent.entry->methodName == methodName && recent.entry->signature == signature
+            && env->IsInstanceOf(instance, recent.entry->javaClass)) {
+            countStatistic(Statistic::MethodCacheHits);
+            return recent.entry;
+        }
+
+        LocalRef<jclass> javaClass(env->GetObjectClass(instance));
+        if (!javaClass) {
+            reportInternalError("class for java object instance not found");
+            return nullptr;
+        }
+
+        {
+            Shard& target = shard(hash);
+            std::lock_guard<std::mutex> lock(target.mutex);
+
+            auto range = target.entries.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                const JavaMethodEntry* entry = it->second;
+
+                if (entry->kind == JavaMethodKind::Instance && entry->methodName == methodName && entry->signature == signature && env->IsSameObject(entry->javaClass, javaClass)) {
+                    countStatistic(Statistic::MethodCacheHits);
+                    recent = {hash, entry};
+                    return entry;
+                }
+            }
+        }
+
+        countStatistic(Statistic::MethodCacheMisses);
+        countStatistic(Statistic::MemberLookups);
+
+        jmethodID method = env->GetMethodID(javaClass, methodName.c_str(), signature.c_str());
+        if (method == nullptr) {
+            reportInternalError("method [" + methodName + "] for java object instance not found, tried signature [" + signature + "]");
+            return nullptr;
+        }
+
+        std::string className = classNameOf(env, javaClass);
+        jclass globalClass = static_cast<jclass>(env->NewGlobalRef(javaClass));
+
+        const JavaMethodEntry* entry = insertEntry(env, hash, new JavaMethodEntry{JavaMethodKind::Instance, className, methodName, signature, globalClass, method, 0});
+        recent = {hash, entry};
+
+        return entry;
+    }
+
+    std::vector<const JavaMethodEntry*> cachedJavaMethods()
+    {
+        std::lock_guard<std::mutex> lock(entriesMutex);
+        return allEntries;
+    }
+
+    JavaMethodCacheStatistics javaMethodCacheStatistics()
+    {
+        std::size_t size = 0;
+        {
+            std::lock_guard<std::mutex> lock(entriesMutex);
+            size = allEntries.size();
+        }
+
+        std::size_t hits = static_cast<std::size_t>(statisticCounter(Statistic::MethodCacheHits).load(std::memory_order_relaxed));
+        std::size_t misses = static_cast<std::size_t>(statisticCounter(Statistic::MethodCacheMisses).load(std::memory_order_relaxed));
+
+        return {hits, misses, size};
+    }
+}
@@ -0,0 +1,95 @@
+/**
+    \file JavaMethodCache.hpp
+    \brief Cache of java classes and method IDs used by the java calls.
+    \author Denis Sorokin
+    \date 23.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // Calls use the cache automatically; FindClass and GetMethodID are made once per method:
+* jh::callStaticMethod<Example, int, int, int>("sum", 1, 2);
+*
+* // The cache can also be used directly:
+* if (auto method = jh::findJavaMethod(env, jh::JavaMethodKind::Static, "com/class/path/Example", "sum", "(II)I"))
+*     env->CallStaticIntMethod(method->javaClass, method->method, 1, 2);
+*
+* // How well the cache works:
+* jh::JavaMethodCacheStatistics statistics = jh::javaMethodCacheStatistics();
+*
+* @endcode
+*/
+
+#ifndef JH_JAVA_METHOD_CACHE_HPP
+#define JH_JAVA_METHOD_CACHE_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <jni.h>
+
+namespace jh
+{
+    enum class JavaMethodKind
+    {
+        Instance,
+        Static,
+        Constructor
+    };
+
+    /**
+    * Resolved java method. Entries are never removed, so they can be kept by pointer.
+    *
+    * @param className Name of the java class like "com/class/path/Example".
+    * @param javaClass Global reference to the class.
+    * @param slot Number of the entry in the creation order, starting from 1.
+    */
+    struct JavaMethodEntry
+    {
+        JavaMethodKind kind;
+        std::string className;
+        std::string methodName;
+        std::string signature;
+        jclass javaClass;
+        jmethodID method;
+        std::size_t slot;
+    };
+
+    /**
+    * Finds the static method or the constructor ('<init>' method) of the java class.
+    *
+    * @return The method or nullptr (the error is already reported) if the class or the method doesn't exist.
+    */
+    const JavaMethodEntry* findJavaMethod(JNIEnv* env, JavaMethodKind kind, const std::string& className, const std::string& methodName, const std::string& signature);
+
+    /**
+    * Finds the method of the class of java object; every class of the objects gets its own entry.
+    * The method that was last found by the thread for this name and signature is reused
+    * without any lookup if the object is an instance of its class.
+    *
+    * @return The method or nullptr (the error is already reported) if the method doesn't exist.
+    */
+    const JavaMethodEntry* findJavaInstanceMethod(JNIEnv* env, jobject instance, const std::string& methodName, const std::string& signature);
+
+    /**
+    * @return All cached methods in the creation order.
+    */
+    std::vector<const JavaMethodEntry*> cachedJavaMethods();
+
+    /**
+    * Statistics of the method cache.
+    */
+    struct JavaMethodCacheStatistics
+    {
+        std::size_t hits;     ///< Lookups served from the cache.
+        std::size_t misses;   ///< Lookups that called FindClass or GetMethodID.
+        std::size_t size;     ///< Methods that are in the cache.
+    };
+
+    JavaMethodCacheStatistics javaMethodCacheStatistics();
+}
+
+#endif
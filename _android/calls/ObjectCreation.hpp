@@ -33,7 +33,10 @@
 #include "../core/ToJavaType.hpp"
 #include "../core/ErrorHandler.hpp"
 #include "../core/JNIEnvironment.hpp"
+#include "../calls/JavaCallProfiler.hpp"
+#include "../calls/JavaMethodCache.hpp"
 #include "../core/JavaMethodSignature.hpp"
+#include "../core/Statistics.hpp"
 
 namespace jh
 {
@@ -49,26 +52,20 @@ namespace jh
     jobject createNewObject(std::string className, typename ToJavaType<ArgumentTypes>::Type ... arguments)
     {
         JNIEnv* env = getCurrentJNIEnvironment();
+        JavaCallTimer timer;
 
         std::string methodSignature = getJavaMethodSignature<void, ArgumentTypes...>();
 
-        jclass javaClass = env->FindClass(className.c_str());
-        if (javaClass == nullptr) {
-            reportInternalError("class not found [" + className + "]");
-            return nullptr;
-        }
-
-        jmethodID javaConstructor = env->GetMethodID(javaClass, "<init>", methodSignature.c_str());
+        const JavaMethodEntry* javaConstructor = findJavaMethod(env, JavaMethodKind::Constructor, className, "<init>", methodSignature);
         if (javaConstructor == nullptr) {
-            reportInternalError("constructor for class [" + className + "] not found, tried signature [" + methodSignature + "]");
             return nullptr;
         }
 
-        jobject result = env->NewObject(javaClass, javaConstructor, arguments...);
+        timer.lookupFinished(javaConstructor);
 
-        env->DeleteLocalRef(javaClass);
+        countStatistic(Statistic::ObjectsCreated);
 
-        return result;
+        return env->NewObject(javaConstructor->javaClass, javaConstructor->method, arguments...);
     }
 
     /**
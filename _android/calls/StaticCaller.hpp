@@ -36,6 +36,8 @@
 #include "../core/ToJavaType.hpp"
 #include "../core/ErrorHandler.hpp"
 #include "../core/JNIEnvironment.hpp"
+#include "../calls/JavaCallProfiler.hpp"
+#include "../calls/JavaMethodCache.hpp"
 #include "../core/JavaMethodSignature.hpp"
 
 namespace jh
@@ -76,6 +78,42 @@ namespace jh
         }
     };
 
+    /**
+    * Class that can call static methods which return jbyte values.
+    */
+    template<class ... ArgumentTypes>
+    struct StaticCaller<jbyte, ArgumentTypes...>
+    {
+        static jbyte call(JNIEnv* env, jclass javaClass, jmethodID javaMethod, ArgumentTypes ... arguments)
+        {
+            return env->CallStaticByteMethod(javaClass, javaMethod, arguments...);
+        }
+    };
+
+    /**
+    * Class that can call static methods which return jchar values.
+    */
+    template<class ... ArgumentTypes>
+    struct StaticCaller<jchar, ArgumentTypes...>
+    {
+        static jchar call(JNIEnv* env, jclass javaClass, jmethodID javaMethod, ArgumentTypes ... arguments)
+        {
+            return env->CallStaticCharMethod(javaClass, javaMethod, arguments...);
+        }
+    };
+
+    /**
+    * Class that can call static methods which return jshort values.
+    */
+    template<class ... ArgumentTypes>
+    struct StaticCaller<jshort, ArgumentTypes...>
+    {
+        static jshort call(JNIEnv* env, jclass javaClass, jmethodID javaMethod, ArgumentTypes ... arguments)
+        {
+            return env->CallStaticShortMethod(javaClass, javaMethod, arguments...);
+        }
+    };
+
     /**
     * Class that can call static methods which return jint values.
     */
@@ -139,22 +177,19 @@ namespace jh
         using RealReturnType = typename ToJavaType<ReturnType>::Type;
 
         JNIEnv* env = getCurrentJNIEnvironment();
+        JavaCallTimer timer;
 
         std::string methodSignature = getJavaMethodSignature<ReturnType, ArgumentTypes...>();
 
-        jclass javaClass = env->FindClass(className.c_str());
-        if (javaClass == nullptr) {
-            reportInternalError("class not found [" + className + "]");
-            return RealReturnType();
-        }
-
-        jmethodID javaMethod = env->GetStaticMethodID(javaClass, methodName.c_str(), methodSignature.c_str());
+        // the class is cached as a global reference, so no local reference is created
+        const JavaMethodEntry* javaMethod = findJavaMethod(env, JavaMethodKind::Static, className, methodName, methodSignature);
         if (javaMethod == nullptr) {
-            reportInternalError("method [" + methodName + "] for class [" + className + "] not found, tried signature [" + methodSignature + "]");
             return RealReturnType();
         }
 
-        return static_cast<RealReturnType>(StaticCaller<typename ToJavaType<ReturnType>::CallReturnType, typename ToJavaType<ArgumentTypes>::Type ...>::call(env, javaClass, javaMethod, arguments...));
+        timer.lookupFinished(javaMethod);
+
+        return static_cast<RealReturnType>(StaticCaller<typename ToJavaType<ReturnType>::CallReturnType, typename ToJavaType<ArgumentTypes>::Type ...>::call(env, javaMethod->javaClass, javaMethod->method, arguments...));
     }
 
     /**
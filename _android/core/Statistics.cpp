@@ -0,0 +1,41 @@
+/**
+    \file Statistics.cpp
+    \brief Global counters of the JNI work done by the library.
+    \author Denis Sorokin
+    \date 24.03.2016
+*/
+
+#include "../core/Statistics.hpp"
+
+namespace jh
+{
+    namespace
+    {
+        std::uint64_t unsignedStatistic(Statistic statistic)
+        {
+            return static_cast<std::uint64_t>(statisticCounter(statistic).load(std::memory_order_relaxed));
+        }
+    }
+
+    Statistics stats()
+    {
+        Statistics result;
+
+        result.classLookups = unsignedStatistic(Statistic::ClassLookups);
+        result.memberLookups = unsignedStatistic(Statistic::MemberLookups);
+        result.methodCacheHits = unsignedStatistic(Statistic::MethodCacheHits);
+        result.methodCacheMisses = unsignedStatistic(Statistic::MethodCacheMisses);
+        result.liveGlobalReferences = statisticCounter(Statistic::LiveGlobalReferences).load(std::memory_order_relaxed);
+        result.liveWeakReferences = statisticCounter(Statistic::LiveWeakReferences).load(std::memory_order_relaxed);
+        result.peakLocalFrameCapacity = unsignedStatistic(Statistic::PeakLocalFrameCapacity);
+        result.threadAttaches = unsignedStatistic(Statistic::ThreadAttaches);
+        result.threadDetaches = unsignedStatistic(Statistic::ThreadDetaches);
+        result.objectsCreated = unsignedStatistic(Statistic::ObjectsCreated);
+        result.stringsCreated = unsignedStatistic(Statistic::StringsCreated);
+        result.arraysCreated = unsignedStatistic(Statistic::ArraysCreated);
+        result.bytesToJava = unsignedStatistic(Statistic::BytesToJava);
+        result.bytesFromJava = unsignedStatistic(Statistic::BytesFromJava);
+
+        return result;
+    }
+}
@@ -68,6 +68,81 @@ namespace jh
         }
     };
 
+    /**
+    * Structure that provides some information about jboolean type.
+    */
+    template<>
+    struct ToJavaType<jboolean>
+    {
+        using Type = jboolean;
+        using CallReturnType = jboolean;
+
+        static std::string signature()
+        {
+            return "Z";
+        }
+    };
+
+    /**
+    * Structure that provides some information about byte (jbyte, int8_t) type.
+    */
+    template<>
+    struct ToJavaType<jbyte>
+    {
+        using Type = jbyte;
+        using CallReturnType = jbyte;
+
+        static std::string signature()
+        {
+            return "B";
+        }
+    };
+
+    /**
+    * Structure that provides some information about jchar (uint16_t) type.
+    */
+    template<>
+    struct ToJavaType<jchar>
+    {
+        using Type = jchar;
+        using CallReturnType = jchar;
+
+        static std::string signature()
+        {
+            return "C";
+        }
+    };
+
+    /**
+    * Structure that provides some information about char16_t type.
+    */
+    template<>
+    struct ToJavaType<char16_t>
+    {
+        using Type = jchar;
+        using CallReturnType = jchar;
+
+        static std::string signature()
+        {
+            return "C";
+        }
+    };
+
+    /**
+    * Structure that provides some information about short (jshort, int16_t) type.
+    */
+    template<>
+    struct ToJavaType<jshort>
+    {
+        using Type = jshort;
+        using CallReturnType = jshort;
+
+        static std::string signature()
+        {
+            return "S";
+        }
+    };
+
     /**
     * Structure that provides some information about int type.
     */
@@ -172,6 +247,23 @@ namespace jh
         }
     };
 
+    /**
+    * Structure that provides some information about jclass type.
+    */
+    template<>
+    struct ToJavaType<jclass> : public JPointerLike<jclass>
+    {
+        static std::string className()
+        {
+            return "java/lang/Class";
+        }
+
+        static std::string signature()
+        {
+            return "L" + className() + ";";
+        }
+    };
+
     /**
     * Structure that describes the types of java arrays.
     *
@@ -191,7 +283,6 @@ namespace jh
     /**
     * Structure that describes the types of custom java arrays.
     */
-    template<>
     template<class JavaType>
     struct ToJavaType<JavaArray<JavaType>> : public JavaArray<JavaType>
     {
@@ -206,6 +297,27 @@ namespace jh
     struct ToJavaType<jbooleanArray> : public JavaArray<jboolean>, public JPointerLike<jbooleanArray>
     { };
 
+    /**
+    * Structure that provides some information about jbyteArray type.
+    */
+    template<>
+    struct ToJavaType<jbyteArray> : public JavaArray<jbyte>, public JPointerLike<jbyteArray>
+    { };
+
+    /**
+    * Structure that provides some information about jcharArray type.
+    */
+    template<>
+    struct ToJavaType<jcharArray> : public JavaArray<jchar>, public JPointerLike<jcharArray>
+    { };
+
+    /**
+    * Structure that provides some information about jshortArray type.
+    */
+    template<>
+    struct ToJavaType<jshortArray> : public JavaArray<jshort>, public JPointerLike<jshortArray>
+    { };
+
     /**
     * Structure that provides some information about jintArray type.
     */
@@ -7,22 +7,28 @@
 
 #include <string>
 #include "../core/ErrorHandler.hpp"
+#include "../core/Statistics.hpp"
 #include "../core/JNIEnvironment.hpp"
 #include "../native/JavaNativeMethod.hpp"
 
 namespace jh
 {
-    bool registerJavaNativeMethods(std::string javaClassName, int methodCount, JNINativeMethod* methodDescriptions)
+    bool registerJavaNativeMethods(std::string javaClassName, int methodCount, const JNINativeMethod* methodDescriptions)
     {
         auto env = getCurrentJNIEnvironment();
 
+        countStatistic(Statistic::ClassLookups);
+
         jclass javaClass = env->FindClass(javaClassName.c_str());
         if (javaClass == nullptr) {
             reportInternalError("unable to find class [" + javaClassName + "] for native methods registration");
             return false;
         }
 
-        if (env->RegisterNatives(javaClass, methodDescriptions, methodCount) < 0) {
+        bool registered = env->RegisterNatives(javaClass, methodDescriptions, methodCount) >= 0;
+        env->DeleteLocalRef(javaClass);
+
+        if (!registered) {
             reportInternalError("unable to register native methods for class [" + javaClassName + "]");
             return false;
         }
@@ -0,0 +1,113 @@
+/**
+    \file JavaObjectRegistry.hpp
+    \brief Concurrent map from java objects to C++ objects.
+    \author Denis Sorokin
+    \date 18.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* jh::JavaObjectRegistry registry;
+*
+* // Link the java object (should be a global reference) with the C++ object:
+* registry.add(javaObject, cppObject);
+*
+* // Find the C++ object from any thread (any kind of reference is accepted):
+* auto cppObject = static_cast<SomeClass*>(registry.find(env, localReference));
+*
+* // Remove the link:
+* registry.remove(javaObject, cppObject);
+*
+* @endcode
+*/
+
+#ifndef JH_JAVA_OBJECT_REGISTRY_HPP
+#define JH_JAVA_OBJECT_REGISTRY_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <jni.h>
+
+namespace jh
+{
+    /**
+    * Returns the same value as 'System.identityHashCode' in java.
+    */
+    jint identityHashCode(JNIEnv* env, jobject object);
+
+    /**
+    * Thread safe map from java objects to C++ objects, which is used by the JavaObjectWrapper
+    * when the wrapped java class has no peer field. Objects are grouped by their identity hash,
+    * so 'IsSameObject' is only called for the objects with the same hash. The map is split
+    * into shards with separate locks, so concurrent native calls rarely wait for each other.
+    */
+    class JavaObjectRegistry
+    {
+    public:
+        JavaObjectRegistry() = default;
+
+        /**
+        * Links the java object with the C++ object.
+        *
+        * @param javaObject Global reference to the java object; should stay valid until it is removed.
+        * @param cppObject Any C++ object.
+        */
+        void add(jobject javaObject, void* cppObject);
+
+        /**
+        * Removes the link between the java object and the C++ object.
+        *
+        * @return True if the link was found and false otherwise.
+        */
+        bool remove(jobject javaObject, void* cppObject);
+
+        /**
+        * Finds the C++ object that is linked with the java object.
+        *
+        * @param env JNI environment of the current thread.
+        * @param javaObject Any kind of reference to the java object.
+        * @return Linked C++ object or nullptr if there is none.
+        */
+        void* find(JNIEnv* env, jobject javaObject) const;
+
+        /**
+        * Returns the number of links.
+        */
+        std::size_t size() const;
+
+    private:
+        static const std::size_t kShardCount = 16;
+
+        struct Entry
+        {
+            jobject javaObject;
+            void* cppObject;
+        };
+
+        /**
+        * Every shard takes its own cache line, so the locks of different shards don't interfere.
+        */
+        struct alignas(64) Shard
+        {
+            mutable std::mutex mutex;
+            std::unordered_multimap<jint, Entry> entries;
+        };
+
+        Shard m_shards[kShardCount];
+
+        const Shard& shard(jint hash) const;
+        Shard& shard(jint hash);
+
+        /**
+        * Registry should not be copied.
+        */
+        JavaObjectRegistry(const JavaObjectRegistry &) = delete;
+        void operator=(const JavaObjectRegistry &) = delete;
+    };
+}
+
+#endif
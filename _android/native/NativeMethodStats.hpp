@@ -0,0 +1,122 @@
+/**
+    \file NativeMethodStats.hpp
+    \brief Optional call counters and latency histograms of java native methods.
+    \author Denis Sorokin
+    \date 22.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // Build with -DJH_NATIVE_METHOD_STATS; without it the native methods are not instrumented at all.
+*
+* // Native methods of wrappers, peers and static native methods are counted automatically:
+* for (const jh::NativeMethodStatistics& method : jh::nativeMethodStats())
+*     log(method.className + "." + method.methodName, method.latency.calls, method.latency.p99Nanoseconds);
+*
+* // Or as text, one line per method:
+* log(jh::formatNativeMethodStats());
+*
+* // Java can get the same text with 'com.jnihelper.NativeMethodStats.dump()' after this call:
+* jh::registerNativeMethodStatsDump();
+*
+* @endcode
+*/
+
+#ifndef JH_NATIVE_METHOD_STATS_HPP
+#define JH_NATIVE_METHOD_STATS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../utils/LatencyStats.hpp"
+
+namespace jh
+{
+    /**
+    * Statistics of one native method.
+    *
+    * @param className Name of the java class.
+    * @param methodName Name of the native method.
+    * @param latency Number of calls and their duration, measured from the entry of the native
+    * method to its return (including the conversion of arguments and results).
+    */
+    struct NativeMethodStatistics
+    {
+        std::string className;
+        std::string methodName;
+        LatencySummary latency;
+    };
+
+    /**
+    * Merges the statistics of all threads.
+    *
+    * @return Statistics of every registered native method; empty if JH_NATIVE_METHOD_STATS is not defined.
+    */
+    std::vector<NativeMethodStatistics> nativeMethodStats();
+
+    /**
+    * @return Statistics of all native methods as text, one line per method.
+    */
+    std::string formatNativeMethodStats();
+
+    /**
+    * Registers 'String dump()' native method of com.jnihelper.NativeMethodStats class,
+    * which returns the result of 'formatNativeMethodStats'.
+    *
+    * @return True if the method was registered.
+    */
+    bool registerNativeMethodStatsDump();
+
+    /**
+    * Reserves the statistics slot of the native method. It should not be used by the programmer itself.
+    *
+    * @return Slot number or 0 if the statistics are disabled or there are too many methods.
+    */
+    std::size_t registerNativeMethodStatsSlot(const std::string& className, const std::string& methodName);
+
+#ifdef JH_NATIVE_METHOD_STATS
+    const std::size_t kMaxNativeMethodStats = 1024;
+
+    struct NativeMethodStatsTag {};
+    using NativeMethodLatencyStats = ShardedLatencyStats<NativeMethodStatsTag, kMaxNativeMethodStats>;
+
+    /**
+    * Records the duration of the native call on destruction.
+    */
+    class NativeMethodTimer
+    {
+    public:
+        explicit NativeMethodTimer(std::size_t slot)
+        : m_slot(slot)
+        , m_start(latency::nowNanoseconds())
+        {
+            // nothing to do here
+        }
+
+        ~NativeMethodTimer()
+        {
+            NativeMethodLatencyStats::record(m_slot, latency::nowNanoseconds() - m_start);
+        }
+
+    private:
+        std::size_t m_slot;
+        std::uint64_t m_start;
+
+        /**
+        * Timer should not be copied.
+        */
+        NativeMethodTimer(const NativeMethodTimer &) = delete;
+        void operator=(const NativeMethodTimer &) = delete;
+    };
+
+    #define JH_NATIVE_METHOD_TIMER(slot) ::jh::NativeMethodTimer jhNativeMethodTimer(slot)
+#else
+    #define JH_NATIVE_METHOD_TIMER(slot) ((void)0)
+#endif
+}
+
+#endif
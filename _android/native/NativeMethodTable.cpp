@@ -0,0 +1,88 @@
+/**
+    \file NativeMethodTable.cpp
+    \brief Static tables of java native methods that are registered all at once.
+    \author Denis Sorokin
+    \date 19.03.2016
+*/
+
+#include <map>
+#include <mutex>
+#include "../core/ErrorHandler.hpp"
+#include "../core/JNIEnvironment.hpp"
+#include "../native/JavaNativeMethod.hpp"
+#include "../native/NativeMethodTable.hpp"
+
+namespace jh
+{
+    namespace
+    {
+        /**
+        * Head of the list of all tables; constant initialized, so tables can be added from any static constructor.
+        */
+        NativeMethodTable* tablesHead = nullptr;
+
+        std::mutex& tablesMutex()
+        {
+            static std::mutex mutex;
+            return mutex;
+        }
+    }
+
+    NativeMethodTable::NativeMethodTable(std::string (*className)(), const JNINativeMethod* methods, std::size_t methodCount)
+    : m_className(className)
+    , m_methods(methods)
+    , m_methodCount(methodCount)
+    , m_registered(false)
+    , m_next(nullptr)
+    {
+        std::lock_guard<std::mutex> lock(tablesMutex());
+        m_next = tablesHead;
+        tablesHead = this;
+    }
+
+    bool registerAllNatives(std::vector<NativeRegistrationTiming>* timings)
+    {
+        std::lock_guard<std::mutex> lock(tablesMutex());
+
+        // tables of the same class are merged in the declaration order
+        std::map<std::string, std::vector<NativeMethodTable*>> tablesByClass;
+        for (NativeMethodTable* table = tablesHead; table; table = table->m_next) {
+            if (!table->m_registered) {
+                auto& tables = tablesByClass[table->m_className()];
+                tables.insert(tables.begin(), table);
+            }
+        }
+
+        bool result = true;
+
+        for (auto& entry : tablesByClass) {
+            auto start = std::chrono::steady_clock::now();
+
+            std::vector<JNINativeMethod> methods;
+            for (NativeMethodTable* table : entry.second) {
+                methods.insert(methods.end(), table->m_methods, table->m_methods + table->m_methodCount);
+            }
+
+            bool registered = registerJavaNativeMethods(entry.first, static_cast<int>(methods.size()), methods.data());
+            if (registered) {
+                for (NativeMethodTable* table : entry.second) {
+                    table->m_registered = true;
+                }
+            } else {
+                getCurrentJNIEnvironment()->ExceptionClear();
+                result = false;
+            }
+
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+            reportInternalInfo((registered ? "registered " : "failed to register ") + std::to_string(methods.size())
+                + " native methods of class [" + entry.first + "] in " + std::to_string(duration.count()) + " us");
+
+            if (timings) {
+                timings->push_back({entry.first, methods.size(), registered, duration});
+            }
+        }
+
+        return result;
+    }
+}
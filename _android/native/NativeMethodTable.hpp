@@ -0,0 +1,119 @@
+/**
+    \file NativeMethodTable.hpp
+    \brief Static tables of java native methods that are registered all at once.
+    \author Denis Sorokin
+    \date 19.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // Native functions get the environment and the class (or the object for instance methods):
+* jint sum(JNIEnv*, jclass, jint x, jint y) { return x + y; }
+* jstring echo(JNIEnv*, jclass, jstring s) { return s; }
+*
+* // Declare the table of native methods of some java class (at namespace scope):
+* JH_NATIVE_METHOD_TABLE(JavaExample,
+*     JH_NATIVE_METHOD("sum", "(II)I", &sum),
+*     JH_NATIVE_METHOD("echo", "(Ljava/lang/String;)Ljava/lang/String;", &echo)
+* );
+*
+* // Register the methods of all tables (for example, in JNI_OnLoad):
+* std::vector<jh::NativeRegistrationTiming> timings;
+* if (!jh::registerAllNatives(&timings))
+*     log("some classes were not registered");
+*
+* @endcode
+*/
+
+#ifndef JH_NATIVE_METHOD_TABLE_HPP
+#define JH_NATIVE_METHOD_TABLE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <jni.h>
+
+#define JH_NATIVE_TABLE_CONCAT_IMPL(first, second) first##second
+#define JH_NATIVE_TABLE_CONCAT(first, second) JH_NATIVE_TABLE_CONCAT_IMPL(first, second)
+
+/**
+* Describes one native method of the table.
+*
+* @param name Name of the java native method (string literal).
+* @param signature Full JNI signature of the method (string literal), like "(ILjava/lang/String;)V".
+* @param function Pointer to the function with 'JNIEnv*' and 'jclass' (or 'jobject') as the first arguments.
+*/
+#define JH_NATIVE_METHOD(name, signature, function) \
+    JNINativeMethod{const_cast<char*>(name), const_cast<char*>(signature), reinterpret_cast<void*>(function)}
+
+/**
+* Declares the table of native methods of the java class. Tables are only linked together
+* at static initialization time, no JNI calls are made until 'jh::registerAllNatives()'.
+*
+* @param JavaClass Custom java class (see JH_JAVA_CUSTOM_CLASS).
+*/
+#define JH_NATIVE_METHOD_TABLE(JavaClass, ...) \
+    static const JNINativeMethod JH_NATIVE_TABLE_CONCAT(jhNativeMethods, __LINE__)[] = { __VA_ARGS__ }; \
+    static jh::NativeMethodTable JH_NATIVE_TABLE_CONCAT(jhNativeMethodTable, __LINE__)( \
+        &JavaClass::className, \
+        JH_NATIVE_TABLE_CONCAT(jhNativeMethods, __LINE__), \
+        sizeof(JH_NATIVE_TABLE_CONCAT(jhNativeMethods, __LINE__)) / sizeof(JNINativeMethod))
+
+namespace jh
+{
+    /**
+    * Result of the native methods registration for one java class.
+    */
+    struct NativeRegistrationTiming
+    {
+        std::string className;              ///< Name of the java class.
+        std::size_t methodCount;            ///< Number of native methods in all tables of this class.
+        bool registered;                    ///< Whether the class was found and methods were registered.
+        std::chrono::microseconds duration; ///< Time spent on 'FindClass' and 'RegisterNatives'.
+    };
+
+    /**
+    * Table of native methods of one java class; should be declared with JH_NATIVE_METHOD_TABLE macro.
+    */
+    class NativeMethodTable
+    {
+    public:
+        /**
+        * Adds the table to the list of all tables; no JNI calls are made here.
+        */
+        NativeMethodTable(std::string (*className)(), const JNINativeMethod* methods, std::size_t methodCount);
+
+    private:
+        friend bool registerAllNatives(std::vector<NativeRegistrationTiming>* timings);
+
+        std::string (*m_className)();
+        const JNINativeMethod* m_methods;
+        std::size_t m_methodCount;
+        bool m_registered;
+        NativeMethodTable* m_next;
+
+        /**
+        * Table should not be copied.
+        */
+        NativeMethodTable(const NativeMethodTable &) = delete;
+        void operator=(const NativeMethodTable &) = delete;
+    };
+
+    /**
+    * Registers the native methods of all declared tables that were not registered yet.
+    * Tables of the same java class are merged, so every class takes only one 'FindClass'
+    * and one 'RegisterNatives' call. The time spent on every class is reported as an info message.
+    *
+    * @param timings Optional vector that receives the registration results of every class.
+    * @return True if all classes were registered and false otherwise.
+    *
+    * @warning Application classes can only be found from java threads (or JNI_OnLoad), not from native threads.
+    */
+    bool registerAllNatives(std::vector<NativeRegistrationTiming>* timings = nullptr);
+}
+
+#endif
@@ -0,0 +1,122 @@
+/**
+    \file InternedJString.hpp
+    \brief Cache of java strings for constant and frequently repeated text.
+    \author Denis Sorokin
+    \date 13.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // String literal; created once per call site and never freed (don't delete it!):
+* jh::callMethod<void, jstring>(someObject, "put", JH_INTERNED_JSTRING("some-constant-key"));
+*
+* // Dynamic text; looked up in the bounded LRU cache, returns a new local reference:
+* jstring key = jh::internedJString(keyName);
+*
+* // Cache size and canonical 'String.intern()' instances (should be done before the first use):
+* jh::configureInternedJStrings(512, true);
+*
+* // Hit rate of the dynamic cache:
+* auto stats = jh::internedJStringStatistics();
+* log(stats.hitRate());
+*
+* @endcode
+*/
+
+#ifndef JH_INTERNED_JSTRING_HPP
+#define JH_INTERNED_JSTRING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <jni.h>
+
+/**
+* Returns the java string for the string literal. Every call site owns its own
+* global reference, which is created on the first call and is never freed, so
+* repeated calls don't create java objects or JNI references at all. If the string
+* can't be created, nullptr is returned and the next call tries again.
+*
+* @warning The result should not be deleted.
+*/
+#define JH_INTERNED_JSTRING(literal) \
+    ([]() -> jstring { \
+        static std::atomic<jstring> interned(nullptr); \
+        jstring cached = interned.load(std::memory_order_acquire); \
+        return cached != nullptr ? cached : jh::createPermanentJString(interned, literal); \
+    }())
+
+namespace jh
+{
+    /**
+    * Statistics of the dynamic interned strings cache.
+    */
+    struct InternedJStringStatistics
+    {
+        std::size_t hits;       ///< Lookups served from the cache.
+        std::size_t misses;     ///< Lookups that created a new java string.
+        std::size_t evictions;  ///< Strings dropped from the cache as least recently used.
+        std::size_t size;       ///< Strings that are in the cache right now.
+        std::size_t literals;   ///< Strings created with 'JH_INTERNED_JSTRING' (their lookups are not counted).
+
+        /**
+        * Part of the lookups served from the cache.
+        */
+        double hitRate() const
+        {
+            std::size_t lookups = hits + misses;
+            return lookups ? static_cast<double>(hits) / lookups : 0.0;
+        }
+    };
+
+    /**
+    * Creates a java string that is never freed.
+    *
+    * @param str UTF-8 text.
+    * @return Global reference to the java string or nullptr (the error is already reported).
+    */
+    jstring createPermanentJString(const char* str);
+
+    /**
+    * Creates a java string that is never freed and stores it in 'cached' unless other
+    * thread did it first; used by 'JH_INTERNED_JSTRING'.
+    *
+    * @param cached Call site storage, stays nullptr if the string can't be created.
+    * @param str UTF-8 text.
+    * @return Global reference to the java string that is stored in 'cached' or nullptr.
+    */
+    jstring createPermanentJString(std::atomic<jstring>& cached, const char* str);
+
+    /**
+    * Returns the java string with the given content from the bounded LRU cache;
+    * the string is created and cached on the first lookup.
+    *
+    * @param str UTF-8 text.
+    * @return New local reference to the cached java string.
+    */
+    jstring internedJString(const std::string& str);
+
+    /**
+    * Changes the dynamic cache settings; cached strings that don't fit are evicted.
+    *
+    * @param capacity Maximum number of cached strings.
+    * @param useJavaIntern Whether new strings are replaced with 'String.intern()' instances,
+    * so java code gets the same objects as for its own literals.
+    */
+    void configureInternedJStrings(std::size_t capacity, bool useJavaIntern = false);
+
+    /**
+    * Evicts all strings from the dynamic cache; literals are kept.
+    */
+    void clearInternedJStrings();
+
+    /**
+    * Returns the statistics of the interned strings.
+    */
+    InternedJStringStatistics internedJStringStatistics();
+}
+
+#endif
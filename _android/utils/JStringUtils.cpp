@@ -5,37 +5,112 @@
     \date 24.01.2016
 */
 
+#include <cstring>
+#include <vector>
+#include "../core/ErrorHandler.hpp"
+#include "../core/Statistics.hpp"
 #include "../core/JNIEnvironment.hpp"
+#include "../utils/UnicodeTranscoder.hpp"
 #include "../utils/JStringUtils.hpp"
 
 namespace jh
 {
+    namespace
+    {
+        /**
+        * Strings up to this length (in UTF-16 code units) are converted on the stack.
+        */
+        const std::size_t kStackBufferLength = 256;
+
+        jstring newJString(const char* str, std::size_t size)
+        {
+            JNIEnv* env = getCurrentJNIEnvironment();
+
+            countStatistic(Statistic::StringsCreated);
+
+            if (size <= kStackBufferLength) {
+                jchar chars[kStackBufferLength];
+                std::size_t length = utf8ToUtf16(str, size, chars);
+                countStatistic(Statistic::BytesToJava, static_cast<std::int64_t>(length * sizeof(jchar)));
+                return env->NewString(chars, static_cast<jsize>(length));
+            }
+
+            std::vector<jchar> chars(size);
+            std::size_t length = utf8ToUtf16(str, size, chars.data());
+            countStatistic(Statistic::BytesToJava, static_cast<std::int64_t>(length * sizeof(jchar)));
+            return env->NewString(chars.data(), static_cast<jsize>(length));
+        }
+    }
+
     jstring createJString(const char* str)
     {
-        JNIEnv* env = getCurrentJNIEnvironment();
-        return env->NewStringUTF(str);
+        if (str == nullptr) {
+            return nullptr;
+        }
+
+        return newJString(str, std::strlen(str));
     }
 
-    jstring createJString(const std::string str)
+    jstring createJString(const char* str, std::size_t size)
     {
-        JNIEnv* env = getCurrentJNIEnvironment();
-        return env->NewStringUTF(str.c_str());
+        return newJString(str, size);
     }
 
     jstring createJString(const std::string& str)
     {
-        JNIEnv* env = getCurrentJNIEnvironment();
-        return env->NewStringUTF(str.c_str());
+        return newJString(str.data(), str.size());
+    }
+
+#if __cplusplus >= 201703L
+    jstring createJString(std::string_view str)
+    {
+        return newJString(str.data(), str.size());
     }
+#endif
 
     std::string jstringToStdString(const jstring javaString)
     {
+        std::string str;
+        jstringToBuffer(javaString, str);
+        return str;
+    }
+
+    void jstringToBuffer(const jstring javaString, std::string& buffer)
+    {
+        buffer.clear();
+
+        if (javaString == nullptr) {
+            return;
+        }
+
         JNIEnv* env = getCurrentJNIEnvironment();
+        std::size_t length = static_cast<std::size_t>(env->GetStringLength(javaString));
 
-        const char* nativeString = env->GetStringUTFChars(javaString, nullptr);
-        std::string str(nativeString);
-        env->ReleaseStringUTFChars(javaString, nativeString);
+        countStatistic(Statistic::BytesFromJava, static_cast<std::int64_t>(length * sizeof(jchar)));
 
-        return str;
+        if (length <= kStackBufferLength) {
+            // short strings are copied out, so the heap is never pinned for them
+            jchar chars[kStackBufferLength];
+            env->GetStringRegion(javaString, 0, static_cast<jsize>(length), chars);
+
+            buffer.resize(length * kMaxUtf8BytesPerUtf16Unit);
+            buffer.resize(utf16ToUtf8(chars, length, &buffer[0]));
+            return;
+        }
+
+        buffer.resize(length * kMaxUtf8BytesPerUtf16Unit);
+
+        // no JNI calls are allowed until the critical section is released
+        const jchar* chars = env->GetStringCritical(javaString, nullptr);
+        if (chars == nullptr) {
+            reportInternalError("unable to access java string characters");
+            buffer.clear();
+            return;
+        }
+
+        std::size_t size = utf16ToUtf8(chars, length, &buffer[0]);
+        env->ReleaseStringCritical(javaString, chars);
+
+        buffer.resize(size);
     }
 }
@@ -13,9 +13,23 @@
 * // Creating java string:
 * jstring js = jh::createJString("someText");
 *
+* // Creating java string from a part of the text:
+* jstring part = jh::createJString(text.data() + offset, size);
+*
 * // Transforming java string to std::string:
 * std::string ss = jh::jstringToStdString(js);
 *
+* // Transforming java strings into the same buffer (its capacity is reused):
+* std::string buffer;
+* for (jstring s : strings) {
+*     jh::jstringToBuffer(s, buffer);
+*     parse(buffer);
+* }
+*
+* // Both functions work with standard UTF-8 (emoji are four-byte sequences, not
+* // surrogate pairs as in modified UTF-8); java strings are built with 'NewString'
+* // and read with 'GetStringRegion'/'GetStringCritical'.
+*
 * @endcode
 */
 
@@ -23,7 +37,13 @@
 #define JH_JSTRING_UTILS_HPP
 
 #include <jni.h>
+#include <cstddef>
 #include <string>
+#include "../utils/UnicodeTranscoder.hpp"
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
 
 namespace jh
 {
@@ -35,13 +55,32 @@ namespace jh
     */
     jstring createJString(const char* str);
 
+    /**
+    * Creates a new java string from the UTF-8 text of the given size.
+    *
+    * @param str Text to be converted; doesn't have to be zero-terminated.
+    * @param size Size of the text in bytes.
+    * @return Equivalent java string; embedded zero characters are kept.
+    */
+    jstring createJString(const char* str, std::size_t size);
+
     /**
     * Creates a new java string from C++-style string.
     *
     * @param str String to be converted.
-    * @return Equivalent java string.
+    * @return Equivalent java string; embedded zero characters are kept.
     */
-    jstring createJString(const std::string str);
+    jstring createJString(const std::string& str);
+
+#if __cplusplus >= 201703L
+    /**
+    * Creates a new java string from the string view.
+    *
+    * @param str String to be converted.
+    * @return Equivalent java string; embedded zero characters are kept.
+    */
+    jstring createJString(std::string_view str);
+#endif
 
     /**
     * Creates a std::string from a java string pointer.
@@ -50,6 +89,15 @@ namespace jh
     * @return Equivalent std::string string.
     */
     std::string jstringToStdString(const jstring str);
+
+    /**
+    * Converts java string into the existing buffer. Buffer capacity is reused,
+    * so converting many strings into the same buffer doesn't allocate memory.
+    *
+    * @param str Java string pointer; the buffer is cleared if it is null.
+    * @param buffer Output buffer; previous content is replaced.
+    */
+    void jstringToBuffer(const jstring str, std::string& buffer);
 }
 
 #endif
@@ -34,6 +34,22 @@
 * // Both strings are still alive!
 * log(jh::jstringToStdString(s1) + jh::jstringToStdString(s2));
 *
+* // Several references can survive the pop too:
+* frame.push();
+* jstring s3 = jh::createJString("s3");
+* jobject o = jh::createNewObject<JavaExample>();
+* frame.popKeeping(&s3, &o);
+*
+* // Reserve room for many local references before creating them:
+* if (jh::ensureLocalCapacity(1000)) {
+*     ...
+* }
+*
+* // Process a lot of objects in frames of 64 references each:
+* jh::forEachInLocalFrames(count, [&](int i) {
+*     jh::callMethod<void>(objects, "process", jh::createJString(names[i]));
+* });
+*
 * @endcode
 */
 
@@ -41,7 +57,10 @@
 #define JH_LOCAL_REFERENCE_FRAME_HPP
 
 #include <jni.h>
+#include <string>
+#include "../core/ErrorHandler.hpp"
 #include "../core/JNIEnvironment.hpp"
+#include "../core/Statistics.hpp"
 
 namespace jh
 {
@@ -81,6 +100,7 @@ namespace jh
 
             if (env->PushLocalFrame(m_frameSize) == 0) {
                 ++m_framesCount;
+                raiseStatistic(Statistic::PeakLocalFrameCapacity, m_frameSize);
                 return true;
             }
 
@@ -130,7 +150,53 @@ namespace jh
             return false;
         }
 
+        /**
+        * Pops the local frame like pop(jobjectToKeep) does, but preserves any number
+        * of local references. The survivors are promoted to global references for
+        * the moment of the pop, so it costs two extra JNI calls per reference.
+        *
+        * @param jobjectsToKeep Pointers to the jobject pointers that should be preserved after local frame destruction.
+        * @return True if there was an active local frame and it was poped. False otherwise.
+        */
+        template <class... JObjectCastable>
+        bool popKeeping(JObjectCastable*... jobjectsToKeep)
+        {
+            if (!m_framesCount) {
+                return false;
+            }
+
+            JNIEnv *env = getCurrentJNIEnvironment();
+
+            // braced lists are evaluated in order; the first element allows an empty pack
+            jobject survivors[] = { nullptr, promote(env, *jobjectsToKeep)... };
+
+            env->PopLocalFrame(nullptr);
+            --m_framesCount;
+
+            int index = 0;
+            int expansion[] = { 0, (restore(env, survivors[++index], jobjectsToKeep), 0)... };
+            (void)expansion;
+
+            return true;
+        }
+
     private:
+        static jobject promote(JNIEnv* env, jobject object)
+        {
+            return object ? env->NewGlobalRef(object) : nullptr;
+        }
+
+        template <class JObjectCastable>
+        static void restore(JNIEnv* env, jobject global, JObjectCastable* jobjectToKeep)
+        {
+            if (global) {
+                *jobjectToKeep = static_cast<JObjectCastable>(env->NewLocalRef(global));
+                env->DeleteGlobalRef(global);
+            } else {
+                *jobjectToKeep = nullptr;
+            }
+        }
+
         /**
         * The size of created frames.
         */
@@ -147,6 +213,56 @@ namespace jh
         LocalReferenceFrame(const LocalReferenceFrame &) = delete;
         void operator=(const LocalReferenceFrame &) = delete;
     };
+
+    /**
+    * Makes sure that at least 'capacity' more local references can be created
+    * in the current frame (java may abort the process if the table overflows).
+    *
+    * @param capacity The number of local references that will be created.
+    * @return True if the references can be created and false otherwise.
+    */
+    inline bool ensureLocalCapacity(int capacity)
+    {
+        JNIEnv* env = getCurrentJNIEnvironment();
+
+        if (env->EnsureLocalCapacity(capacity) != 0) {
+            env->ExceptionClear();
+            reportInternalError("unable to reserve " + std::to_string(capacity) + " local references");
+            return false;
+        }
+
+        raiseStatistic(Statistic::PeakLocalFrameCapacity, capacity);
+
+        return true;
+    }
+
+    /**
+    * Calls the function for every index from 0 to 'count' and pops the local references
+    * created by the function every 'chunkSize' iterations, so loops of any length
+    * don't overflow the local reference table.
+    *
+    * @param count The number of iterations.
+    * @param function Callable with the signature 'void(int index)'.
+    * @param chunkSize The number of iterations per local frame; also the capacity of every frame.
+    */
+    template <class Function>
+    void forEachInLocalFrames(int count, Function function, int chunkSize = 64)
+    {
+        if (chunkSize <= 0) {
+            chunkSize = 1;
+        }
+
+        LocalReferenceFrame frame(chunkSize);
+
+        for (int i = 0; i < count; ++i) {
+            if (i && i % chunkSize == 0) {
+                frame.pop();
+                frame.push();
+            }
+
+            function(i);
+        }
+    }
 }
 
 #endif
@@ -0,0 +1,118 @@
+/**
+    \file SharedJavaObject.cpp
+    \brief Reference-counted owner of a single global java reference.
+    \author Denis Sorokin
+    \date 16.03.2016
+*/
+
+#include <atomic>
+#include <utility>
+#include "../core/JNIEnvironment.hpp"
+#include "../core/Statistics.hpp"
+#include "../utils/DeferredRelease.hpp"
+#include "../utils/SharedJavaObject.hpp"
+
+namespace jh
+{
+    struct SharedJavaObject::ControlBlock
+    {
+        std::atomic<std::size_t> owners;
+        jobject globalReference;
+    };
+
+    SharedJavaObject::SharedJavaObject()
+    : m_block(nullptr)
+    {
+        // nothing to do here
+    }
+
+    SharedJavaObject::SharedJavaObject(jobject object)
+    : m_block(nullptr)
+    {
+        if (object) {
+            jobject globalReference = getCurrentJNIEnvironment()->NewGlobalRef(object);
+            if (globalReference) {
+                countStatistic(Statistic::LiveGlobalReferences);
+            }
+            adopt(globalReference);
+        }
+    }
+
+    SharedJavaObject::SharedJavaObject(const SharedJavaObject& other)
+    : m_block(other.m_block)
+    {
+        if (m_block) {
+            m_block->owners.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    SharedJavaObject::SharedJavaObject(SharedJavaObject&& other)
+    : m_block(other.m_block)
+    {
+        other.m_block = nullptr;
+    }
+
+    SharedJavaObject& SharedJavaObject::operator=(const SharedJavaObject& other)
+    {
+        SharedJavaObject copy(other);
+        std::swap(m_block, copy.m_block);
+        return *this;
+    }
+
+    SharedJavaObject& SharedJavaObject::operator=(SharedJavaObject&& other)
+    {
+        std::swap(m_block, other.m_block);
+        return *this;
+    }
+
+    SharedJavaObject::~SharedJavaObject()
+    {
+        reset();
+    }
+
+    void SharedJavaObject::reset()
+    {
+        if (!m_block) {
+            return;
+        }
+
+        // the last owner sees all the writes of the other owners
+        if (m_block->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            releaseGlobalReference(m_block->globalReference);
+            delete m_block;
+        }
+
+        m_block = nullptr;
+    }
+
+    std::size_t SharedJavaObject::useCount() const
+    {
+        return m_block ? m_block->owners.load(std::memory_order_relaxed) : 0;
+    }
+
+    jobject SharedJavaObject::get() const
+    {
+        return m_block ? m_block->globalReference : nullptr;
+    }
+
+    SharedJavaObject::operator jobject() const
+    {
+        return get();
+    }
+
+    SharedJavaObject::operator bool() const
+    {
+        return m_block != nullptr;
+    }
+
+    void SharedJavaObject::adopt(jobject globalReference)
+    {
+        if (!globalReference) {
+            return;
+        }
+
+        m_block = new ControlBlock();
+        m_block->owners.store(1, std::memory_order_relaxed);
+        m_block->globalReference = globalReference;
+    }
+}
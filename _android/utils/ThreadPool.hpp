@@ -0,0 +1,104 @@
+/**
+    \file ThreadPool.hpp
+    \brief Fixed-size pool of native worker threads.
+    \author Denis Sorokin
+    \date 01.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // Pool that runs tasks on 8 threads (7 workers + the calling thread):
+* jh::ThreadPool pool(8);
+*
+* // Runs 100 tasks and waits until all of them are finished:
+* pool.run(100, [&] (std::size_t taskIndex) {
+*     process(taskIndex);
+* });
+*
+* @endcode
+*/
+
+#ifndef JH_THREAD_POOL_HPP
+#define JH_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jh
+{
+    /**
+    * Pool of native threads that execute batches of indexed tasks. Worker threads
+    * are never attached to the JVM, so the tasks should not make any JNI calls.
+    * The thread that calls 'run' executes tasks too, so the pool with concurrency N
+    * owns only N - 1 worker threads.
+    */
+    class ThreadPool
+    {
+    public:
+        /**
+        * Creates the pool.
+        *
+        * @param concurrency Total number of threads that execute tasks (including the calling one). Zero means the number of CPU cores.
+        */
+        explicit ThreadPool(std::size_t concurrency = 0);
+
+        /**
+        * Stops and joins all worker threads.
+        */
+        ~ThreadPool();
+
+        /**
+        * Returns the total number of threads that execute tasks (including the calling one).
+        */
+        std::size_t concurrency() const;
+
+        /**
+        * Executes 'task' for every index in [0, taskCount) and returns when all of them are finished.
+        * Only one batch is executed at a time; concurrent 'run' calls are serialized.
+        *
+        * If a task throws, tasks that are not started yet are skipped, and the first exception
+        * is rethrown from 'run' after all threads have left the batch.
+        *
+        * @param taskCount Number of tasks in the batch.
+        * @param task Function that receives the index of the task.
+        */
+        void run(std::size_t taskCount, const std::function<void(std::size_t)>& task);
+
+    private:
+        void workerLoop();
+        void executeTasks();
+        void failBatch(std::exception_ptr exception);
+
+        std::vector<std::thread> m_workers;
+
+        std::mutex m_runMutex;
+        std::mutex m_mutex;
+        std::condition_variable m_batchStarted;
+        std::condition_variable m_batchFinished;
+
+        const std::function<void(std::size_t)>* m_task;
+        std::size_t m_taskCount;
+        std::atomic<std::size_t> m_nextTask;
+        std::size_t m_busyWorkers;
+        unsigned long long m_batchNumber;
+        bool m_stopping;
+        std::exception_ptr m_batchException;
+
+        /**
+        * Pool should not be copied.
+        */
+        ThreadPool(const ThreadPool &) = delete;
+        void operator=(const ThreadPool &) = delete;
+    };
+}
+
+#endif
@@ -0,0 +1,324 @@
+/**
+    \file JNIHelperBench.cpp
+    \brief Microbenchmarks of the library primitives in a desktop JVM.
+    \author Denis Sorokin
+    \date 25.03.2016
+*/
+
+/**
+* Usage:
+*
+* @code{.sh}
+*
+* # Every benchmark is one CSV line in stdout; errors of the library go to stderr:
+* ./jnihelper_bench > results.csv
+*
+* # Only the benchmarks with the substring in their names, with additional JVM options:
+* ./jnihelper_bench --filter=dispatch --jvm=-Xmx1g
+*
+* @endcode
+*
+* Columns: benchmark,parameter,operations,median_ns_per_op,min_ns_per_op
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <jni.h>
+#include "JNIHelper.hpp"
+#include "desktop/DesktopJNIEnvironment.hpp"
+
+// the jar with the java fixtures is passed by the build
+#ifndef JH_BENCH_CLASSPATH
+#define JH_BENCH_CLASSPATH "jnihelper_bench_fixtures.jar"
+#endif
+
+JH_JAVA_CUSTOM_CLASS(JavaBenchExample, "com/quint/bench/BenchExample");
+JH_JAVA_CUSTOM_CLASS(JavaBenchPeer, "com/quint/bench/BenchPeer");
+JH_JAVA_CUSTOM_CLASS(JavaBenchIdentity, "com/quint/bench/BenchIdentity");
+
+namespace
+{
+    const int kRepetitions = 7;
+    const int kOperationsPerFrame = 256;
+
+    std::string benchmarkFilter;
+
+    /**
+    * Keeps the compiler from removing the operations without side effects.
+    */
+    template<class T>
+    void doNotOptimize(const T& value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /**
+    * Runs the batch 'kRepetitions' times after the warm-up and prints the median and the best time per operation.
+    *
+    * @param batch Function that performs 'count' operations.
+    */
+    template<class Batch>
+    void measure(const std::string& name, const std::string& parameter, int operations, Batch batch)
+    {
+        if (!benchmarkFilter.empty() && name.find(benchmarkFilter) == std::string::npos) {
+            return;
+        }
+
+        batch(operations / 10 + 1);
+
+        std::vector<double> samples;
+        for (int i = 0; i < kRepetitions; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            batch(operations);
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+            samples.push_back(static_cast<double>(elapsed.count()) / operations);
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        std::printf("%s,%s,%d,%.2f,%.2f\n", name.c_str(), parameter.c_str(), operations, samples[samples.size() / 2], samples.front());
+        std::fflush(stdout);
+    }
+
+    /**
+    * Measures one operation at a time; local references are freed in frames of 'kOperationsPerFrame'
+    * operations, so the results include the amortized cost of the frames.
+    */
+    template<class Operation>
+    void measureEach(const std::string& name, const std::string& parameter, int operations, Operation operation)
+    {
+        measure(name, parameter, operations, [&operation](int count) {
+            for (int done = 0; done < count; done += kOperationsPerFrame) {
+                jh::LocalReferenceFrame frame(kOperationsPerFrame * 2);
+
+                int end = std::min(count, done + kOperationsPerFrame);
+                for (int i = done; i < end; ++i) {
+                    operation(i);
+                }
+            }
+        });
+    }
+
+    class BenchPeerWrapper : public jh::JavaObjectWrapper<JavaBenchPeer, BenchPeerWrapper>
+    {
+    public:
+        BenchPeerWrapper(int id)
+        : m_id(id)
+        {
+            // nothing to do here
+        }
+
+    private:
+        int m_id;
+
+        void linkJavaNativeMethods() override
+        {
+            registerNativeMethod<&BenchPeerWrapper::nativeId>("nativeId");
+            usePeerField("nativeHandle");
+        }
+
+        jobject initializeJavaObject() override
+        {
+            return jh::createNewObject<JavaBenchPeer>();
+        }
+
+        int nativeId()
+        {
+            return m_id;
+        }
+    };
+
+    class BenchIdentityWrapper : public jh::JavaObjectWrapper<JavaBenchIdentity, BenchIdentityWrapper>
+    {
+    public:
+        BenchIdentityWrapper(int id)
+        : m_id(id)
+        {
+            // nothing to do here
+        }
+
+    private:
+        int m_id;
+
+        void linkJavaNativeMethods() override
+        {
+            registerNativeMethod<&BenchIdentityWrapper::nativeId>("nativeId");
+        }
+
+        jobject initializeJavaObject() override
+        {
+            return jh::createNewObject<JavaBenchIdentity>();
+        }
+
+        int nativeId()
+        {
+            return m_id;
+        }
+    };
+
+    void benchmarkCalls()
+    {
+        jh::JavaObjectPointer example(jh::createNewObject<JavaBenchExample, int>(7));
+
+        measureEach("call_static_method", "int(int,int)", 1000000, [](int i) {
+            doNotOptimize(jh::callStaticMethod<JavaBenchExample, int, int, int>("staticSum", i, 1));
+        });
+
+        measureEach("call_method", "int()", 1000000, [&example](int) {
+            doNotOptimize(jh::callMethod<int>(example, "get"));
+        });
+
+        measureEach("call_method", "void(int)", 1000000, [&example](int i) {
+            jh::callMethod<void, int>(example, "set", i);
+        });
+
+        measureEach("create_new_object", "()", 500000, [](int) {
+            doNotOptimize(jh::createNewObject<JavaBenchExample>());
+        });
+
+        measureEach("create_new_object", "(int)", 500000, [](int i) {
+            doNotOptimize(jh::createNewObject<JavaBenchExample, int>(i));
+        });
+    }
+
+    void benchmarkArrays()
+    {
+        for (int size : {16, 1024, 65536}) {
+            std::vector<int> values(size, 42);
+            int operations = std::max(1000, 4000000 / size);
+
+            measureEach("array_builder_build", "int[" + std::to_string(size) + "]", operations, [&values](int) {
+                doNotOptimize(jh::JavaArrayBuilder<int>().add(values.begin(), values.end()).build());
+            });
+
+            jh::JavaObjectPointer array(jh::JavaArrayBuilder<int>().add(values.begin(), values.end()).build());
+
+            measureEach("jarray_to_vector", "int[" + std::to_string(size) + "]", operations, [&array](int) {
+                auto vector = jh::jarrayToVector<jintArray>(static_cast<jintArray>(array.get()));
+                doNotOptimize(vector.data());
+            });
+        }
+    }
+
+    void benchmarkStrings()
+    {
+        for (int length : {16, 256, 4096}) {
+            std::string ascii(length, 'a');
+            std::string cyrillic;
+            for (int i = 0; i < length / 2; ++i) {
+                cyrillic += "\xd1\x8f";
+            }
+
+            int operations = std::max(10000, 4000000 / length);
+
+            measureEach("create_jstring", "ascii" + std::to_string(length), operations, [&ascii](int) {
+                doNotOptimize(jh::createJString(ascii));
+            });
+
+            measureEach("create_jstring", "cyrillic" + std::to_string(length), operations, [&cyrillic](int) {
+                doNotOptimize(jh::createJString(cyrillic));
+            });
+
+            jh::JavaObjectPointer asciiString(jh::createJString(ascii));
+            jh::JavaObjectPointer cyrillicString(jh::createJString(cyrillic));
+
+            measureEach("jstring_to_std_string", "ascii" + std::to_string(length), operations, [&asciiString](int) {
+                std::string result = jh::jstringToStdString(static_cast<jstring>(asciiString.get()));
+                doNotOptimize(result.data());
+            });
+
+            measureEach("jstring_to_std_string", "cyrillic" + std::to_string(length), operations, [&cyrillicString](int) {
+                std::string result = jh::jstringToStdString(static_cast<jstring>(cyrillicString.get()));
+                doNotOptimize(result.data());
+            });
+        }
+    }
+
+    void benchmarkObjectPointers()
+    {
+        jh::JavaObjectPointer source(jh::createNewObject<JavaBenchExample>());
+
+        measureEach("java_object_pointer_copy", "global", 1000000, [&source](int) {
+            jh::JavaObjectPointer copy(source);
+            doNotOptimize(copy.get());
+        });
+
+        jh::JavaObjectPointer first(jh::createNewObject<JavaBenchExample>());
+        jh::JavaObjectPointer second;
+
+        measureEach("java_object_pointer_move", "global", 10000000, [&first, &second](int) {
+            second = std::move(first);
+            first = std::move(second);
+            doNotOptimize(first.get());
+        });
+    }
+
+    /**
+    * Java calls the native method of one of N live wrappers in a loop.
+    */
+    template<class Wrapper, class JavaClass>
+    void benchmarkDispatch(const std::string& name)
+    {
+        for (int wrapperCount : {1, 100, 10000}) {
+            std::vector<std::unique_ptr<Wrapper>> wrappers;
+            jh::JavaArrayBuilder<JavaClass> builder;
+
+            jh::forEachInLocalFrames(wrapperCount, [&](int i) {
+                wrappers.emplace_back(new Wrapper(i));
+                builder.add(wrappers.back()->object());
+            });
+
+            jh::JavaObjectPointer objects(builder.build());
+
+            measure(name, std::to_string(wrapperCount) + "_objects", 1000000, [&objects](int count) {
+                jobjectArray array = static_cast<jobjectArray>(objects.get());
+                doNotOptimize(jh::callStaticMethod<JavaClass, int, jh::JavaArray<JavaClass>, int>("dispatch", array, count));
+            });
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string classPath = JH_BENCH_CLASSPATH;
+    std::vector<std::string> jvmOptions;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* argument = argv[i];
+
+        if (std::strncmp(argument, "--filter=", 9) == 0) {
+            benchmarkFilter = argument + 9;
+        } else if (std::strncmp(argument, "--classpath=", 12) == 0) {
+            classPath = argument + 12;
+        } else if (std::strncmp(argument, "--jvm=", 6) == 0) {
+            jvmOptions.push_back(argument + 6);
+        } else {
+            std::fprintf(stderr, "usage: %s [--filter=substring] [--classpath=path] [--jvm=option]...\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (!jh::bench::createJavaVM(classPath, jvmOptions)) {
+        return 1;
+    }
+
+    std::printf("benchmark,parameter,operations,median_ns_per_op,min_ns_per_op\n");
+
+    benchmarkCalls();
+    benchmarkArrays();
+    benchmarkStrings();
+    benchmarkObjectPointers();
+    benchmarkDispatch<BenchPeerWrapper, JavaBenchPeer>("wrapper_dispatch_peer_field");
+    benchmarkDispatch<BenchIdentityWrapper, JavaBenchIdentity>("wrapper_dispatch_identity_registry");
+
+    jh::bench::destroyJavaVM();
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+/**
+    \file DesktopJNIEnvironment.cpp
+    \brief In-process desktop JVM that replaces JNIEnvironment.cpp in the benchmarks.
+    \author Denis Sorokin
+    \date 25.03.2016
+*/
+
+#include <jni.h>
+#include "../../_android/core/JNIEnvironment.hpp"
+#include "../../_android/core/ErrorHandler.hpp"
+#include "../../_android/core/Statistics.hpp"
+#include "DesktopJNIEnvironment.hpp"
+
+namespace jh
+{
+    namespace
+    {
+        JavaVM* desktopJavaVM = nullptr;
+    }
+
+    namespace bench
+    {
+        bool createJavaVM(const std::string& classPath, const std::vector<std::string>& options)
+        {
+            std::vector<std::string> optionStrings;
+            optionStrings.push_back("-Djava.class.path=" + classPath);
+            optionStrings.insert(optionStrings.end(), options.begin(), options.end());
+
+            std::vector<JavaVMOption> vmOptions;
+            for (const std::string& option : optionStrings) {
+                JavaVMOption vmOption;
+                vmOption.optionString = const_cast<char*>(option.c_str());
+                vmOption.extraInfo = nullptr;
+                vmOptions.push_back(vmOption);
+            }
+
+            JavaVMInitArgs arguments;
+            arguments.version = JNI_VERSION_1_6;
+            arguments.nOptions = static_cast<jint>(vmOptions.size());
+            arguments.options = vmOptions.data();
+            arguments.ignoreUnrecognized = JNI_FALSE;
+
+            JNIEnv* env = nullptr;
+            if (JNI_CreateJavaVM(&desktopJavaVM, reinterpret_cast<void**>(&env), &arguments) != JNI_OK) {
+                desktopJavaVM = nullptr;
+                reportInternalError("couldn't create java VM with class path [" + classPath + "]");
+                return false;
+            }
+
+            return true;
+        }
+
+        void destroyJavaVM()
+        {
+            if (desktopJavaVM) {
+                desktopJavaVM->DestroyJavaVM();
+                desktopJavaVM = nullptr;
+            }
+        }
+    }
+
+    JavaVM* getJavaVM()
+    {
+        return desktopJavaVM;
+    }
+
+    JNIEnv* getCurrentJNIEnvironment()
+    {
+        JNIEnv* env = nullptr;
+        JavaVM* javaVM = getJavaVM();
+
+        javaVM->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6);
+
+        if (env == nullptr) {
+            reportInternalError("jni environment not found");
+        }
+
+        return env;
+    }
+
+    JNIEnv* tryGetCurrentJNIEnvironment()
+    {
+        JNIEnv* env = nullptr;
+        JavaVM* javaVM = getJavaVM();
+
+        if (javaVM == nullptr || javaVM->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+            return nullptr;
+        }
+
+        return env;
+    }
+
+    JNIEnvironmentGuarantee::JNIEnvironmentGuarantee()
+    : m_threadShouldBeDetached(false)
+    {
+        JNIEnv* env = nullptr;
+        JavaVM* javaVM = getJavaVM();
+
+        int getEnvStatus = javaVM->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6);
+
+        if (getEnvStatus == JNI_EDETACHED) {
+            // the desktop jni.h takes void** here, unlike the android one
+            if (javaVM->AttachCurrentThread(reinterpret_cast<void**>(&env), nullptr) != 0) {
+                reportInternalError("couldn't attach current thread to java VM");
+            } else {
+                m_threadShouldBeDetached = true;
+                countStatistic(Statistic::ThreadAttaches);
+            }
+        }
+
+        if (env == nullptr) {
+            reportInternalError("couldn't get jni environment for current thread");
+        }
+    }
+
+    JNIEnvironmentGuarantee::~JNIEnvironmentGuarantee()
+    {
+        if (m_threadShouldBeDetached) {
+            getJavaVM()->DetachCurrentThread();
+            countStatistic(Statistic::ThreadDetaches);
+        }
+    }
+}
@@ -0,0 +1,35 @@
+/**
+    \file DesktopJNIEnvironment.hpp
+    \brief In-process desktop JVM that replaces JNIEnvironment.cpp in the benchmarks.
+    \author Denis Sorokin
+    \date 25.03.2016
+*/
+
+#ifndef JH_BENCH_DESKTOP_JNI_ENVIRONMENT_HPP
+#define JH_BENCH_DESKTOP_JNI_ENVIRONMENT_HPP
+
+#include <string>
+#include <vector>
+#include <jni.h>
+
+namespace jh
+{
+    namespace bench
+    {
+        /**
+        * Creates the JVM through 'JNI_CreateJavaVM'; the calling thread stays attached to it.
+        *
+        * @param classPath Class path of the java fixtures.
+        * @param options Additional JVM options, like "-Xmx512m".
+        * @return True if the JVM was created and false otherwise.
+        */
+        bool createJavaVM(const std::string& classPath, const std::vector<std::string>& options);
+
+        /**
+        * Destroys the JVM created by 'createJavaVM'.
+        */
+        void destroyJavaVM();
+    }
+}
+
+#endif
@@ -0,0 +1,34 @@
+/**
+    \file log.h
+    \brief Desktop replacement of the android logging used by ErrorHandler.hpp.
+    \author Denis Sorokin
+    \date 25.03.2016
+*/
+
+#ifndef JH_BENCH_ANDROID_LOG_H
+#define JH_BENCH_ANDROID_LOG_H
+
+#include <cstdio>
+
+typedef enum android_LogPriority
+{
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT
+} android_LogPriority;
+
+/**
+* Messages go to stderr, so the benchmark results in stdout stay machine-readable.
+*/
+inline int __android_log_write(int, const char* tag, const char* text)
+{
+    return std::fprintf(stderr, "%s: %s\n", tag, text);
+}
+
+#endif
@@ -0,0 +1,36 @@
+package com.quint.bench;
+
+public class BenchExample
+{
+    private int value;
+
+    // CONSTRUCTORS:
+
+    BenchExample()
+    {
+    }
+
+    BenchExample(int value)
+    {
+        this.value = value;
+    }
+
+    // STATIC METHODS:
+
+    static int staticSum(int x, int y)
+    {
+        return x + y;
+    }
+
+    // INSTANCE METHODS:
+
+    int get()
+    {
+        return value;
+    }
+
+    void set(int value)
+    {
+        this.value = value;
+    }
+}
@@ -0,0 +1,16 @@
+package com.quint.bench;
+
+public class BenchIdentity
+{
+    public native int nativeId();
+
+    // The loop stays in java, so only the native dispatch itself is measured.
+    static int dispatch(BenchIdentity[] objects, int calls)
+    {
+        int sum = 0;
+        for (int i = 0; i < calls; ++i) {
+            sum += objects[i % objects.length].nativeId();
+        }
+        return sum;
+    }
+}
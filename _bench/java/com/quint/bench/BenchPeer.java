@@ -0,0 +1,19 @@
+package com.quint.bench;
+
+public class BenchPeer
+{
+    // Pointer to the C++ wrapper; only used by the native code.
+    private long nativeHandle;
+
+    public native int nativeId();
+
+    // The loop stays in java, so only the native dispatch itself is measured.
+    static int dispatch(BenchPeer[] peers, int calls)
+    {
+        int sum = 0;
+        for (int i = 0; i < calls; ++i) {
+            sum += peers[i % peers.length].nativeId();
+        }
+        return sum;
+    }
+}
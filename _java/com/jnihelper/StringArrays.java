@@ -0,0 +1,55 @@
+package com.jnihelper;
+
+import java.nio.charset.Charset;
+
+/**
+ * Java side of jh::toJavaStringArray and jh::fromJavaStringArray. Strings cross the
+ * JNI boundary as one UTF-8 byte array plus an array of offsets, so the number of JNI
+ * calls doesn't depend on the number of strings.
+ */
+final class StringArrays
+{
+    private static final Charset UTF8 = Charset.forName("UTF-8");
+
+    private StringArrays()
+    {
+    }
+
+    /**
+     * Splits packed UTF-8 text into strings; string 'i' is [offsets[i], offsets[i + 1]).
+     */
+    static String[] fromUtf8(byte[] utf8, int[] offsets)
+    {
+        String[] strings = new String[offsets.length - 1];
+
+        for (int i = 0; i < strings.length; ++i) {
+            strings[i] = new String(utf8, offsets[i], offsets[i + 1] - offsets[i], UTF8);
+        }
+
+        return strings;
+    }
+
+    /**
+     * Packs strings into one UTF-8 byte array; 'offsetsOut' should have 'strings.length + 1'
+     * elements and receives the offsets of every string. Null strings are packed as empty ones.
+     */
+    static byte[] toUtf8(String[] strings, int[] offsetsOut)
+    {
+        byte[][] encoded = new byte[strings.length][];
+        int size = 0;
+
+        for (int i = 0; i < strings.length; ++i) {
+            encoded[i] = strings[i] != null ? strings[i].getBytes(UTF8) : new byte[0];
+            offsetsOut[i] = size;
+            size += encoded[i].length;
+        }
+        offsetsOut[strings.length] = size;
+
+        byte[] utf8 = new byte[size];
+        for (int i = 0; i < strings.length; ++i) {
+            System.arraycopy(encoded[i], 0, utf8, offsetsOut[i], encoded[i].length);
+        }
+
+        return utf8;
+    }
+}
@@ -0,0 +1,16 @@
+package com.jnihelper;
+
+/**
+ * Java side of jh::formatNativeMethodStats; available after jh::registerNativeMethodStatsDump.
+ */
+public final class NativeMethodStats
+{
+    private NativeMethodStats()
+    {
+    }
+
+    /**
+     * Returns the call counts and latencies of native methods, one line per method.
+     */
+    public static native String dump();
+}
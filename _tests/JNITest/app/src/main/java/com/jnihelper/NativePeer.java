@@ -0,0 +1,94 @@
+package com.jnihelper;
+
+import java.lang.ref.PhantomReference;
+import java.lang.ref.ReferenceQueue;
+import java.util.Collections;
+import java.util.HashSet;
+import java.util.Set;
+
+/**
+ * Java side of jh::JavaNativePeer. The constructor creates the C++ peer of the object;
+ * 'close()' destroys it, or, if it wasn't called, the cleaner thread destroys it after
+ * the object is collected. Works like java.lang.ref.Cleaner, which is missing on older
+ * Android versions.
+ */
+public abstract class NativePeer implements AutoCloseable
+{
+    private static final ReferenceQueue<NativePeer> s_queue = new ReferenceQueue<NativePeer>();
+    private static final Set<PeerReference> s_references = Collections.synchronizedSet(new HashSet<PeerReference>());
+
+    static {
+        Thread cleaner = new Thread(new Runnable() {
+            @Override
+            public void run()
+            {
+                while (true) {
+                    try {
+                        ((PeerReference) s_queue.remove()).clean();
+                    } catch (InterruptedException e) {
+                        // keep cleaning
+                    }
+                }
+            }
+        }, "NativePeerCleaner");
+        cleaner.setDaemon(true);
+        cleaner.start();
+    }
+
+    /**
+     * Destroys the peer exactly once; it doesn't reference the java object, so it can
+     * be run after the object is collected.
+     */
+    private static final class PeerReference extends PhantomReference<NativePeer>
+    {
+        private long m_handle;
+
+        PeerReference(NativePeer peer, long handle)
+        {
+            super(peer, s_queue);
+            m_handle = handle;
+        }
+
+        synchronized void clean()
+        {
+            if (m_handle != 0) {
+                destroyPeer(m_handle);
+                m_handle = 0;
+            }
+            s_references.remove(this);
+        }
+    }
+
+    /**
+     * Pointer to the C++ peer; zero after 'close()'. Read by the native methods of subclasses.
+     */
+    private long nativeHandle;
+    private final PeerReference m_reference;
+
+    protected NativePeer()
+    {
+        nativeHandle = createPeer(this, getClass());
+
+        if (nativeHandle != 0) {
+            m_reference = new PeerReference(this, nativeHandle);
+            s_references.add(m_reference);
+        } else {
+            m_reference = null;
+        }
+    }
+
+    /**
+     * Destroys the C++ peer; native methods called after this report an error.
+     */
+    @Override
+    public void close()
+    {
+        if (m_reference != null) {
+            nativeHandle = 0;
+            m_reference.clean();
+        }
+    }
+
+    private static native long createPeer(NativePeer peer, Class<?> type);
+    private static native void destroyPeer(long handle);
+}
@@ -0,0 +1,124 @@
+package com.jnihelper;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+/**
+ * Java side of jh::SharedRingBuffer. The ring lives in a direct byte buffer that is
+ * written by C++ producers; this class drains it in batches without JNI calls per record.
+ * Instances are created by the C++ code; one reader should be used by one thread at a time.
+ */
+public final class SharedRingBuffer
+{
+    // keep in sync with the layout in SharedRingBuffer.cpp
+    private static final int CAPACITY_OFFSET = 0;
+    private static final int HEAD_OFFSET = 64;
+    private static final int TAIL_OFFSET = 128;
+    private static final int WAITING_OFFSET = 256;
+    private static final int DATA_OFFSET = 320;
+    private static final int PADDING_RECORD = -1;
+
+    /**
+     * Receives one record; its payload is 'length' bytes of 'buffer' starting from 'offset'.
+     * The payload should be copied if it is needed after this call.
+     */
+    public interface RecordHandler
+    {
+        void onRecord(ByteBuffer buffer, int offset, int length);
+    }
+
+    private final ByteBuffer m_buffer;
+    private final long m_address;
+    private final long m_capacity;
+    private final Object m_lock = new Object();
+    private boolean m_signaled;
+
+    SharedRingBuffer(ByteBuffer buffer)
+    {
+        m_buffer = buffer.duplicate().order(ByteOrder.nativeOrder());
+        m_address = nativeAddress(buffer);
+        m_capacity = m_buffer.getLong(CAPACITY_OFFSET);
+    }
+
+    /**
+     * Passes all published records to the handler and frees their space.
+     *
+     * @return Number of drained records.
+     */
+    public int drain(RecordHandler handler)
+    {
+        long head = nativeLoad(m_address + HEAD_OFFSET);
+        long tail = m_buffer.getLong(TAIL_OFFSET);
+        int count = 0;
+
+        while (tail < head) {
+            int index = (int) (tail & (m_capacity - 1));
+            int length = m_buffer.getInt(DATA_OFFSET + index);
+
+            if (length == PADDING_RECORD) {
+                tail += m_capacity - index;
+                continue;
+            }
+
+            handler.onRecord(m_buffer, DATA_OFFSET + index + 4, length);
+            tail += (4 + length + 7) & ~7;
+            ++count;
+        }
+
+        if (tail != m_buffer.getLong(TAIL_OFFSET)) {
+            nativeStore(m_address + TAIL_OFFSET, tail);
+        }
+
+        return count;
+    }
+
+    /**
+     * Blocks until producers publish something or the timeout expires.
+     *
+     * @return True if there are records to drain.
+     */
+    public boolean await(long timeoutMillis) throws InterruptedException
+    {
+        nativeStore(m_address + WAITING_OFFSET, 1);
+
+        try {
+            synchronized (m_lock) {
+                long deadline = System.currentTimeMillis() + timeoutMillis;
+
+                while (!m_signaled && !hasRecords()) {
+                    long left = deadline - System.currentTimeMillis();
+                    if (left <= 0) {
+                        break;
+                    }
+                    m_lock.wait(left);
+                }
+
+                m_signaled = false;
+            }
+        } finally {
+            nativeStore(m_address + WAITING_OFFSET, 0);
+        }
+
+        return hasRecords();
+    }
+
+    private boolean hasRecords()
+    {
+        return nativeLoad(m_address + HEAD_OFFSET) != m_buffer.getLong(TAIL_OFFSET);
+    }
+
+    // called by C++ producers once per batch when the consumer is waiting
+    private void wakeUp()
+    {
+        synchronized (m_lock) {
+            m_signaled = true;
+            m_lock.notifyAll();
+        }
+    }
+
+    private static native long nativeAddress(ByteBuffer buffer);
+
+    // sequentially consistent 64-bit accesses performed by the native code
+    private static native long nativeLoad(long address);
+    private static native void nativeStore(long address, long value);
+}
@@ -2,6 +2,9 @@ package com.quint;
 
 import android.util.Log;
 
+import com.jnihelper.SharedRingBuffer;
+
+import java.nio.ByteBuffer;
 import java.util.Arrays;
 import java.util.Map;
 
@@ -104,6 +107,11 @@ public class Example
 
     public native static void staticNativeMethod();
 
+    // NATIVE METHOD TABLES
+
+    public native static int tableSum(int x, int y);
+    public native static String tableEcho(String s);
+
     // INSTANCE NATIVE METHODS
 
     public void testNativeMethod()
@@ -189,6 +197,109 @@ public class Example
 
     public native String array8(String[] sss);
 
+    // SMALL PRIMITIVE TYPES
+    public byte byte1(byte b)
+    {
+        return (byte)(b + 1);
+    }
+
+    public static short short1(short s)
+    {
+        return (short)(s * 2);
+    }
+
+    public char char1(char c)
+    {
+        return Character.toUpperCase(c);
+    }
+
+    public byte[] bytes1(byte[] bytes)
+    {
+        byte[] result = new byte[bytes.length];
+        for (int i = 0; i < bytes.length; ++i) {
+            result[i] = bytes[bytes.length - 1 - i];
+        }
+        return result;
+    }
+
+    public void testNativeMethodShorts()
+    {
+        Log.i(TAG, "shorts1: " + Arrays.toString(shorts1(new short[] {1, -2, 300})));
+
+        float[] values = new float[] {1, 2, 5};
+        normalize1(values);
+        Log.i(TAG, "normalize1 (should be [0.2, 0.4, 1.0]): " + Arrays.toString(values));
+    }
+
+    public native short[] shorts1(short[] samples);
+    public native void normalize1(float[] values);
+
+    // DIRECT BUFFERS
+    public long buffer1(ByteBuffer buffer)
+    {
+        long sum = 0;
+        for (int i = 0; i < buffer.capacity(); ++i) {
+            sum += buffer.get(i);
+            buffer.put(i, (byte) 7);
+        }
+        return sum;
+    }
+
+    public ByteBuffer buffer2()
+    {
+        ByteBuffer buffer = ByteBuffer.allocateDirect(16);
+        for (int i = 0; i < 16; ++i) {
+            buffer.put(i, (byte) i);
+        }
+        return buffer;
+    }
+
+    public static String tempFile(int size) throws java.io.IOException
+    {
+        java.io.File file = java.io.File.createTempFile("mapped", ".bin");
+        file.deleteOnExit();
+
+        java.io.FileOutputStream stream = new java.io.FileOutputStream(file);
+        for (int i = 0; i < size; ++i) {
+            stream.write(i % 128);
+        }
+        stream.close();
+
+        return file.getAbsolutePath();
+    }
+
+    public int buffer3(ByteBuffer buffer)
+    {
+        Log.i(TAG, "buffer3: read-only = " + buffer.isReadOnly() + ", capacity = " + buffer.capacity());
+        return buffer.get(0);
+    }
+
+    // INTERNED STRINGS
+    public static String internedKey()
+    {
+        return "key0";
+    }
+
+    // SHARED RING BUFFER
+    private long m_ringSum;
+
+    public long ring1(SharedRingBuffer reader)
+    {
+        m_ringSum = 0;
+
+        int count = reader.drain(new SharedRingBuffer.RecordHandler() {
+            @Override
+            public void onRecord(ByteBuffer buffer, int offset, int length) {
+                for (int i = 0; i < length; i += 4) {
+                    m_ringSum += buffer.getInt(offset + i);
+                }
+            }
+        });
+
+        Log.i(TAG, "ring1: drained " + count + " records");
+        return m_ringSum;
+    }
+
     // MAP METHODS
     public void map1(Map<String, String> intToInt)
     {
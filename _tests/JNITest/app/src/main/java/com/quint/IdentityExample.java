@@ -0,0 +1,11 @@
+package com.quint;
+
+public class IdentityExample
+{
+    public int callNativeId()
+    {
+        return nativeId();
+    }
+
+    public native int nativeId();
+}
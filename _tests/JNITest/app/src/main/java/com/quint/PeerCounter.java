@@ -0,0 +1,6 @@
+package com.quint;
+
+public class PeerCounter extends com.jnihelper.NativePeer
+{
+    public native int increment();
+}
@@ -0,0 +1,14 @@
+package com.quint;
+
+public class PeerExample
+{
+    // Pointer to the C++ wrapper; only used by the native code.
+    private long nativeHandle;
+
+    public int callNativeId()
+    {
+        return nativeId();
+    }
+
+    public native int nativeId();
+}
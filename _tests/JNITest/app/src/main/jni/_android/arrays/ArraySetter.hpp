@@ -9,6 +9,7 @@
 #define JH_ARRAY_SETTER_HPP
 
 #include <jni.h>
+#include "../core/Statistics.hpp"
 
 namespace jh
 {
@@ -27,6 +28,46 @@ namespace jh
         static void set(JNIEnv* env, jbooleanArray array, jsize size, jboolean* elements)
         {
             env->SetBooleanArrayRegion(array, 0, size, elements);
+            countStatistic(Statistic::BytesToJava, static_cast<std::int64_t>(size) * sizeof(*elements));
+        }
+    };
+
+    /**
+    * Implementations for setting elements of java byte arrays.
+    */
+    template<>
+    struct JavaArraySetter<jbyteArray>
+    {
+        static void set(JNIEnv* env, jbyteArray array, jsize size, jbyte* elements)
+        {
+            env->SetByteArrayRegion(array, 0, size, elements);
+            countStatistic(Statistic::BytesToJava, static_cast<std::int64_t>(size) * sizeof(*elements));
+        }
+    };
+
+    /**
+    * Implementations for setting elements of java char arrays.
+    */
+    template<>
+    struct JavaArraySetter<jcharArray>
+    {
+        static void set(JNIEnv* env, jcharArray array, jsize size, jchar* elements)
+        {
+            env->SetCharArrayRegion(array, 0, size, elements);
+            countStatistic(Statistic::BytesToJava, static_cast<std::int64_t>(size) * sizeof(*elements));
+        }
+    };
+
+    /**
+    * Implementations for setting elements of java short arrays.
+    */
+    template<>
+    struct JavaArraySetter<jshortArray>
+    {
+        static void set(JNIEnv* env, jshortArray array, jsize size, jshort* elements)
+        {
+            env->SetShortArrayRegion(array, 0, size, elements);
+            countStatistic(Statistic::BytesToJava, static_cast<std::int64_t>(size) * sizeof(*elements));
         }
     };
 
@@ -39,6 +80,7 @@ namespace jh
         static void set(JNIEnv* env, jintArray array, jsize size, jint* elements)
         {
             env->SetIntArrayRegion(array, 0, size, elements);
+            countStatistic(Statistic::BytesToJava, static_cast<std::int64_t>(size) * sizeof(*elements));
         }
     };
 
@@ -51,6 +93,7 @@ namespace jh
         static void set(JNIEnv* env, jlongArray array, jsize size, jlong* elements)
         {
             env->SetLongArrayRegion(array, 0, size, elements);
+            countStatistic(Statistic::BytesToJava, static_cast<std::int64_t>(size) * sizeof(*elements));
         }
     };
 
@@ -63,6 +106,7 @@ namespace jh
         static void set(JNIEnv* env, jfloatArray array, jsize size, jfloat* elements)
         {
             env->SetFloatArrayRegion(array, 0, size, elements);
+            countStatistic(Statistic::BytesToJava, static_cast<std::int64_t>(size) * sizeof(*elements));
         }
     };
 
@@ -75,6 +119,7 @@ namespace jh
         static void set(JNIEnv* env, jdoubleArray array, jsize size, jdouble* elements)
         {
             env->SetDoubleArrayRegion(array, 0, size, elements);
+            countStatistic(Statistic::BytesToJava, static_cast<std::int64_t>(size) * sizeof(*elements));
         }
     };
 
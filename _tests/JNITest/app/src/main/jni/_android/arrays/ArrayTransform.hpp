@@ -0,0 +1,116 @@
+/**
+    \file ArrayTransform.hpp
+    \brief In-place parallel processing of java primitive arrays.
+    \author Denis Sorokin
+    \date 01.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // Pool with 8 threads; should be created once and reused:
+* static jh::ThreadPool pool(8);
+*
+* // Normalize java float array in place:
+* jh::parallelTransform(floatArray, [] (jfloat* first, jfloat* last) {
+*     for (auto it = first; it != last; ++it) {
+*         *it = *it / 255.0f;
+*     }
+* }, pool);
+*
+* // Same, but the VM is allowed to copy the array instead of pinning it:
+* jh::parallelTransform(floatArray, kernel, pool, jh::ArrayPinMode::Elements);
+*
+* @endcode
+*/
+
+#ifndef JH_ARRAY_TRANSFORM_HPP
+#define JH_ARRAY_TRANSFORM_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <jni.h>
+#include "../core/ToJavaType.hpp"
+#include "../core/ErrorHandler.hpp"
+#include "../core/JNIEnvironment.hpp"
+#include "../arrays/ArrayPinner.hpp"
+#include "../utils/ThreadPool.hpp"
+
+namespace jh
+{
+    /**
+    * Size of the cache line; ranges processed by different threads never share one.
+    */
+    const std::size_t kCacheLineSize = 64;
+
+    /**
+    * Pins the java primitive array once, splits it into cache line aligned ranges and
+    * runs the kernel on these ranges in parallel. All changes are committed back to the
+    * java array before this function returns.
+    *
+    * The kernel is called as 'kernel(ElementType* first, ElementType* last)' on the pool
+    * threads and must not make any JNI calls (in the critical mode the VM may be blocked
+    * until the array is released, so the kernel should also avoid any other blocking).
+    *
+    * @param array Java primitive array (jfloatArray, jintArray, etc).
+    * @param kernel Function that processes the range of elements.
+    * @param pool Pool of threads that run the kernel.
+    * @param mode How the array elements should be accessed.
+    * @return True if the array was processed or false otherwise.
+    */
+    template<class JavaArrayType, class Kernel>
+    bool parallelTransform(JavaArrayType array, Kernel kernel, ThreadPool& pool, ArrayPinMode mode = ArrayPinMode::Critical)
+    {
+        using ElementType = typename PinnedJavaArray<JavaArrayType>::ElementType;
+
+        if (array == nullptr) {
+            reportInternalError("parallel transform of null array");
+            return false;
+        }
+
+        JNIEnv* env = getCurrentJNIEnvironment();
+
+        // no JNI calls are allowed after pinning, so the length is read first
+        auto size = static_cast<std::size_t>(env->GetArrayLength(array));
+        if (size == 0) {
+            return true;
+        }
+
+        // released with JNI_ABORT if the kernel throws; the pool rethrows only after all of its threads have stopped touching the elements
+        PinnedJavaArray<JavaArrayType> pinned(env, array, mode);
+        ElementType* elements = pinned.elements();
+        if (elements == nullptr) {
+            reportInternalError("unable to pin java array for parallel transform");
+            return false;
+        }
+
+        const std::size_t lineElements = std::max<std::size_t>(1, kCacheLineSize / sizeof(ElementType));
+        const std::size_t misalignment = reinterpret_cast<std::uintptr_t>(elements) % kCacheLineSize;
+        const std::size_t head = misalignment ? (kCacheLineSize - misalignment) / sizeof(ElementType) : 0;
+
+        std::size_t rangeCount = std::min(pool.concurrency(), (size + lineElements - 1) / lineElements);
+        std::size_t rangeSize = (size + rangeCount - 1) / rangeCount;
+        rangeSize = (rangeSize + lineElements - 1) / lineElements * lineElements;
+
+        if (rangeCount <= 1) {
+            kernel(elements, elements + size);
+        } else {
+            pool.run(rangeCount, [&] (std::size_t range) {
+                std::size_t first = range == 0 ? 0 : std::min(size, head + range * rangeSize);
+                std::size_t last = range + 1 == rangeCount ? size : std::min(size, head + (range + 1) * rangeSize);
+
+                if (first < last) {
+                    kernel(elements + first, elements + last);
+                }
+            });
+        }
+
+        pinned.commit();
+
+        return true;
+    }
+}
+
+#endif
@@ -0,0 +1,99 @@
+/**
+    \file StringArrays.cpp
+    \brief Bulk conversion of string arrays with a constant number of JNI calls.
+    \author Denis Sorokin
+    \date 14.03.2016
+*/
+
+#include "../core/ErrorHandler.hpp"
+#include "../core/Statistics.hpp"
+#include "../core/JNIEnvironment.hpp"
+#include "../core/JavaCustomClass.hpp"
+#include "../calls/StaticCaller.hpp"
+#include "../arrays/StringArrays.hpp"
+
+namespace jh
+{
+    namespace
+    {
+        JH_JAVA_CUSTOM_CLASS(JavaStringArrays, "com/jnihelper/StringArrays");
+    }
+
+    jobjectArray packedUtf8ToJavaStringArray(const std::string& utf8, const std::vector<jint>& offsets)
+    {
+        if (offsets.empty()) {
+            reportInternalError("packed strings should have at least one offset");
+            return nullptr;
+        }
+
+        JNIEnv* env = getCurrentJNIEnvironment();
+
+        jbyteArray bytes = env->NewByteArray(static_cast<jsize>(utf8.size()));
+        jintArray javaOffsets = env->NewIntArray(static_cast<jsize>(offsets.size()));
+
+        if (bytes == nullptr || javaOffsets == nullptr) {
+            reportInternalError("unable to allocate packed strings");
+            env->DeleteLocalRef(bytes);
+            env->DeleteLocalRef(javaOffsets);
+            return nullptr;
+        }
+
+        env->SetByteArrayRegion(bytes, 0, static_cast<jsize>(utf8.size()), reinterpret_cast<const jbyte*>(utf8.data()));
+        env->SetIntArrayRegion(javaOffsets, 0, static_cast<jsize>(offsets.size()), offsets.data());
+
+        countStatistic(Statistic::ArraysCreated, 3);
+        countStatistic(Statistic::StringsCreated, static_cast<std::int64_t>(offsets.size()) - 1);
+        countStatistic(Statistic::BytesToJava, static_cast<std::int64_t>(utf8.size() + offsets.size() * sizeof(jint)));
+
+        jobjectArray result = callStaticMethod<JavaStringArrays, JavaArray<jstring>, jbyteArray, jintArray>("fromUtf8", bytes, javaOffsets);
+
+        env->DeleteLocalRef(bytes);
+        env->DeleteLocalRef(javaOffsets);
+
+        return result;
+    }
+
+    std::vector<std::string> fromJavaStringArray(jobjectArray array)
+    {
+        std::vector<std::string> result;
+
+        if (array == nullptr) {
+            return result;
+        }
+
+        JNIEnv* env = getCurrentJNIEnvironment();
+
+        jsize count = env->GetArrayLength(array);
+        jintArray javaOffsets = env->NewIntArray(count + 1);
+        if (javaOffsets == nullptr) {
+            reportInternalError("unable to allocate packed string offsets");
+            return result;
+        }
+
+        jbyteArray bytes = callStaticMethod<JavaStringArrays, jbyteArray, JavaArray<jstring>, jintArray>("toUtf8", array, javaOffsets);
+        if (bytes == nullptr) {
+            reportInternalError("unable to pack java strings");
+            env->DeleteLocalRef(javaOffsets);
+            return result;
+        }
+
+        std::vector<jint> offsets(static_cast<std::size_t>(count) + 1);
+        env->GetIntArrayRegion(javaOffsets, 0, count + 1, offsets.data());
+
+        std::string utf8(static_cast<std::size_t>(offsets.back()), '\0');
+        env->GetByteArrayRegion(bytes, 0, offsets.back(), reinterpret_cast<jbyte*>(&utf8[0]));
+
+        countStatistic(Statistic::ArraysCreated, 2);
+        countStatistic(Statistic::BytesFromJava, static_cast<std::int64_t>(utf8.size() + offsets.size() * sizeof(jint)));
+
+        env->DeleteLocalRef(bytes);
+        env->DeleteLocalRef(javaOffsets);
+
+        result.reserve(static_cast<std::size_t>(count));
+        for (jsize i = 0; i < count; ++i) {
+            result.emplace_back(utf8, static_cast<std::size_t>(offsets[i]), static_cast<std::size_t>(offsets[i + 1] - offsets[i]));
+        }
+
+        return result;
+    }
+}
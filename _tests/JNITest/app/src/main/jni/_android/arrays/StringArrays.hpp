@@ -0,0 +1,116 @@
+/**
+    \file StringArrays.hpp
+    \brief Bulk conversion of string arrays with a constant number of JNI calls.
+    \author Denis Sorokin
+    \date 14.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // Any range of std::string or const char* elements to 'String[]':
+* std::vector<std::string> names = {"one", "two", "three"};
+* jobjectArray javaNames = jh::toJavaStringArray(names);
+*
+* // Or a part of the range:
+* jobjectArray firstTwo = jh::toJavaStringArray(names.begin(), names.begin() + 2);
+*
+* // 'String[]' back to std::vector<std::string>:
+* std::vector<std::string> parsed = jh::fromJavaStringArray(javaNames);
+*
+* @endcode
+*/
+
+#ifndef JH_STRING_ARRAYS_HPP
+#define JH_STRING_ARRAYS_HPP
+
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <jni.h>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+namespace jh
+{
+    /**
+    * Creates 'String[]' from the packed UTF-8 text in a constant number of JNI calls.
+    * Strings are split on the java side by 'com.jnihelper.StringArrays' (see '_java' folder).
+    *
+    * @param utf8 All strings one after another.
+    * @param offsets Offsets of the strings in 'utf8' plus the total size in the end.
+    * @return New java string array or nullptr on error.
+    */
+    jobjectArray packedUtf8ToJavaStringArray(const std::string& utf8, const std::vector<jint>& offsets);
+
+    inline void appendPackedString(std::string& utf8, const std::string& str)
+    {
+        utf8.append(str);
+    }
+
+    inline void appendPackedString(std::string& utf8, const char* str)
+    {
+        if (str) {
+            utf8.append(str);
+        }
+    }
+
+#if __cplusplus >= 201703L
+    inline void appendPackedString(std::string& utf8, std::string_view str)
+    {
+        utf8.append(str.data(), str.size());
+    }
+#endif
+
+    /**
+    * Creates 'String[]' from the range of strings. All strings cross the JNI boundary
+    * as one byte array, so the number of JNI calls doesn't depend on the number of strings.
+    *
+    * @param first Iterator to the first string (std::string or const char*).
+    * @param last Iterator after the last string.
+    * @return New java string array or nullptr on error.
+    */
+    template<class Iterator>
+    jobjectArray toJavaStringArray(Iterator first, Iterator last)
+    {
+        std::string utf8;
+        std::vector<jint> offsets(1, 0);
+
+        for (; first != last; ++first) {
+            appendPackedString(utf8, *first);
+            offsets.push_back(static_cast<jint>(utf8.size()));
+        }
+
+        return packedUtf8ToJavaStringArray(utf8, offsets);
+    }
+
+    /**
+    * Creates 'String[]' from the container of strings.
+    */
+    template<class Range>
+    jobjectArray toJavaStringArray(const Range& strings)
+    {
+        return toJavaStringArray(std::begin(strings), std::end(strings));
+    }
+
+    inline jobjectArray toJavaStringArray(std::initializer_list<std::string> strings)
+    {
+        return toJavaStringArray(strings.begin(), strings.end());
+    }
+
+    /**
+    * Converts 'String[]' to the vector of UTF-8 strings in a constant number of JNI calls.
+    * Null elements become empty strings.
+    *
+    * @param array Java string array.
+    * @return Vector of strings; empty on error.
+    */
+    std::vector<std::string> fromJavaStringArray(jobjectArray array);
+}
+
+#endif
@@ -0,0 +1,180 @@
+/**
+    \file DirectBuffer.cpp
+    \brief Sharing native memory with java code through direct byte buffers.
+    \author Denis Sorokin
+    \date 04.03.2016
+*/
+
+#include <utility>
+#include "../core/ErrorHandler.hpp"
+#include "../core/JNIEnvironment.hpp"
+#include "../buffers/DirectBuffer.hpp"
+
+namespace jh
+{
+    DirectBuffer::DirectBuffer()
+    : m_data(nullptr)
+    , m_size(0)
+    {
+        // nothing to do here
+    }
+
+    DirectBuffer::DirectBuffer(std::size_t size)
+    : DirectBuffer()
+    {
+        wrap(new char[size], size, [] (void* data) {
+            delete[] static_cast<char*>(data);
+        });
+    }
+
+    DirectBuffer::DirectBuffer(void* data, std::size_t size)
+    : DirectBuffer()
+    {
+        wrap(data, size, nullptr);
+    }
+
+    DirectBuffer::DirectBuffer(void* data, std::size_t size, Deleter deleter)
+    : DirectBuffer()
+    {
+        wrap(data, size, std::move(deleter));
+    }
+
+    DirectBuffer::DirectBuffer(DirectBuffer&& other)
+    : DirectBuffer()
+    {
+        *this = std::move(other);
+    }
+
+    DirectBuffer& DirectBuffer::operator=(DirectBuffer&& other)
+    {
+        if (&other == this)
+            return *this;
+
+        reset();
+
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_deleter, other.m_deleter);
+        m_byteBuffer = std::move(other.m_byteBuffer);
+
+        return *this;
+    }
+
+    DirectBuffer::~DirectBuffer()
+    {
+        reset();
+    }
+
+    void DirectBuffer::reset()
+    {
+        // only our global reference is deleted here; byte buffers that java still holds keep
+        // pointing to this memory, so the owner must make sure they are dropped before the reset
+        m_byteBuffer.release();
+
+        if (m_deleter && m_data) {
+            m_deleter(m_data);
+        }
+
+        m_data = nullptr;
+        m_size = 0;
+        m_deleter = nullptr;
+    }
+
+    void* DirectBuffer::data() const
+    {
+        return m_data;
+    }
+
+    std::size_t DirectBuffer::size() const
+    {
+        return m_size;
+    }
+
+    jobject DirectBuffer::object() const
+    {
+        return m_byteBuffer.get();
+    }
+
+    DirectBuffer::operator jobject() const
+    {
+        return object();
+    }
+
+    DirectBuffer::operator bool() const
+    {
+        return object() != nullptr;
+    }
+
+    void DirectBuffer::wrap(void* data, std::size_t size, Deleter deleter)
+    {
+        m_data = data;
+        m_size = size;
+        m_deleter = std::move(deleter);
+
+        if (data == nullptr) {
+            reportInternalError("unable to create direct buffer for null memory");
+            return;
+        }
+
+        JNIEnv* env = getCurrentJNIEnvironment();
+
+        jobject byteBuffer = env->NewDirectByteBuffer(data, static_cast<jlong>(size));
+        if (byteBuffer == nullptr) {
+            reportInternalError("unable to create direct buffer - not supported by the VM");
+            return;
+        }
+
+        m_byteBuffer = byteBuffer;
+        env->DeleteLocalRef(byteBuffer);
+    }
+
+    DirectBufferView::DirectBufferView()
+    : m_byteBuffer(nullptr)
+    , m_data(nullptr)
+    , m_size(0)
+    {
+        // nothing to do here
+    }
+
+    DirectBufferView::DirectBufferView(jobject byteBuffer)
+    : DirectBufferView()
+    {
+        if (byteBuffer == nullptr) {
+            return;
+        }
+
+        JNIEnv* env = getCurrentJNIEnvironment();
+
+        void* data = env->GetDirectBufferAddress(byteBuffer);
+        jlong capacity = env->GetDirectBufferCapacity(byteBuffer);
+
+        if (data == nullptr || capacity < 0) {
+            reportInternalError("java object is not a direct buffer");
+            return;
+        }
+
+        m_byteBuffer = byteBuffer;
+        m_data = data;
+        m_size = static_cast<std::size_t>(capacity);
+    }
+
+    void* DirectBufferView::data() const
+    {
+        return m_data;
+    }
+
+    std::size_t DirectBufferView::size() const
+    {
+        return m_size;
+    }
+
+    jobject DirectBufferView::object() const
+    {
+        return m_byteBuffer;
+    }
+
+    DirectBufferView::operator bool() const
+    {
+        return m_data != nullptr;
+    }
+}
@@ -0,0 +1,231 @@
+/**
+    \file DirectBufferPool.cpp
+    \brief Recycling pool of native-backed direct byte buffers.
+    \author Denis Sorokin
+    \date 05.03.2016
+*/
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include "../core/ErrorHandler.hpp"
+#include "../buffers/DirectBufferPool.hpp"
+
+namespace jh
+{
+    const std::size_t DirectBufferPool::kUnpooled;
+
+    DirectBufferPool::Lease::Lease()
+    : m_pool(nullptr)
+    , m_sizeClass(kUnpooled)
+    , m_size(0)
+    {
+        // nothing to do here
+    }
+
+    DirectBufferPool::Lease::Lease(DirectBufferPool* pool, std::size_t sizeClass, std::size_t size, DirectBuffer buffer)
+    : m_pool(pool)
+    , m_sizeClass(sizeClass)
+    , m_size(size)
+    , m_buffer(std::move(buffer))
+    {
+        // nothing to do here
+    }
+
+    DirectBufferPool::Lease::Lease(Lease&& other)
+    : Lease()
+    {
+        *this = std::move(other);
+    }
+
+    DirectBufferPool::Lease& DirectBufferPool::Lease::operator=(Lease&& other)
+    {
+        if (&other == this)
+            return *this;
+
+        release();
+
+        std::swap(m_pool, other.m_pool);
+        std::swap(m_sizeClass, other.m_sizeClass);
+        std::swap(m_size, other.m_size);
+        m_buffer = std::move(other.m_buffer);
+
+        return *this;
+    }
+
+    DirectBufferPool::Lease::~Lease()
+    {
+        release();
+    }
+
+    void DirectBufferPool::Lease::release()
+    {
+        if (m_pool) {
+            m_pool->giveBack(m_sizeClass, std::move(m_buffer));
+        }
+
+        m_pool = nullptr;
+        m_sizeClass = kUnpooled;
+        m_size = 0;
+    }
+
+    void* DirectBufferPool::Lease::data() const
+    {
+        return m_buffer.data();
+    }
+
+    std::size_t DirectBufferPool::Lease::size() const
+    {
+        return m_size;
+    }
+
+    std::size_t DirectBufferPool::Lease::capacity() const
+    {
+        return m_buffer.size();
+    }
+
+    jobject DirectBufferPool::Lease::object() const
+    {
+        return m_buffer.object();
+    }
+
+    DirectBufferPool::Lease::operator jobject() const
+    {
+        return object();
+    }
+
+    DirectBufferPool::Lease::operator bool() const
+    {
+        return static_cast<bool>(m_buffer);
+    }
+
+    DirectBufferPool::DirectBufferPool(std::size_t minBufferSize, std::size_t maxBufferSize, std::size_t maxIdleBuffersPerClass)
+    : m_minBufferSize(std::max<std::size_t>(1, minBufferSize))
+    , m_maxIdleBuffersPerClass(maxIdleBuffersPerClass)
+    , m_statistics()
+    {
+        // the doubling stops before it overflows, so huge maximum sizes are clamped to the largest class that fits
+        std::size_t classCount = 1;
+        while (sizeOfClass(classCount - 1) < maxBufferSize && sizeOfClass(classCount - 1) <= std::numeric_limits<std::size_t>::max() / 2) {
+            ++classCount;
+        }
+
+        m_idleBuffers.resize(classCount);
+        for (auto& buffers : m_idleBuffers) {
+            buffers.reserve(maxIdleBuffersPerClass);
+        }
+    }
+
+    DirectBufferPool::Lease DirectBufferPool::acquire(std::size_t size)
+    {
+        std::size_t sizeClass = sizeClassOf(size);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            ++m_statistics.acquisitions;
+            ++m_statistics.leased;
+            m_statistics.highWaterMark = std::max(m_statistics.highWaterMark, m_statistics.leased);
+
+            if (sizeClass != kUnpooled && !m_idleBuffers[sizeClass].empty()) {
+                DirectBuffer buffer = std::move(m_idleBuffers[sizeClass].back());
+                m_idleBuffers[sizeClass].pop_back();
+                ++m_statistics.reuses;
+
+                return Lease(this, sizeClass, size, std::move(buffer));
+            }
+
+            ++m_statistics.allocations;
+        }
+
+        // allocation happens outside of the lock
+        DirectBuffer buffer(sizeClass != kUnpooled ? sizeOfClass(sizeClass) : size);
+        if (!buffer) {
+            reportInternalError("unable to allocate pooled direct buffer");
+        }
+
+        return Lease(this, sizeClass, size, std::move(buffer));
+    }
+
+    void DirectBufferPool::preallocate(std::size_t size, std::size_t count)
+    {
+        std::size_t sizeClass = sizeClassOf(size);
+        if (sizeClass == kUnpooled) {
+            reportInternalError("unable to preallocate direct buffers larger than the largest size class");
+            return;
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_idleBuffers[sizeClass].size() >= m_maxIdleBuffersPerClass) {
+                    return;
+                }
+            }
+
+            DirectBuffer buffer(sizeOfClass(sizeClass));
+            if (!buffer) {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_statistics.allocations;
+
+            if (m_idleBuffers[sizeClass].size() < m_maxIdleBuffersPerClass) {
+                m_idleBuffers[sizeClass].push_back(std::move(buffer));
+            }
+        }
+    }
+
+    void DirectBufferPool::trim()
+    {
+        std::vector<std::vector<DirectBuffer>> released(m_idleBuffers.size());
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (std::size_t i = 0; i < m_idleBuffers.size(); ++i) {
+                released[i].swap(m_idleBuffers[i]);
+                m_idleBuffers[i].reserve(m_maxIdleBuffersPerClass);
+            }
+        }
+
+        // buffers are destroyed outside of the lock
+    }
+
+    DirectBufferPool::Statistics DirectBufferPool::statistics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_statistics;
+    }
+
+    std::size_t DirectBufferPool::sizeClassOf(std::size_t size) const
+    {
+        for (std::size_t sizeClass = 0; sizeClass < m_idleBuffers.size(); ++sizeClass) {
+            if (size <= sizeOfClass(sizeClass)) {
+                return sizeClass;
+            }
+        }
+
+        return kUnpooled;
+    }
+
+    std::size_t DirectBufferPool::sizeOfClass(std::size_t sizeClass) const
+    {
+        return m_minBufferSize << sizeClass;
+    }
+
+    void DirectBufferPool::giveBack(std::size_t sizeClass, DirectBuffer buffer)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_statistics.leased;
+
+            if (buffer && sizeClass != kUnpooled && m_idleBuffers[sizeClass].size() < m_maxIdleBuffersPerClass) {
+                m_idleBuffers[sizeClass].push_back(std::move(buffer));
+                return;
+            }
+        }
+
+        // the buffer that doesn't fit into the pool is destroyed outside of the lock
+    }
+}
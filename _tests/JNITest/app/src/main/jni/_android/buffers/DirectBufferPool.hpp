@@ -0,0 +1,196 @@
+/**
+    \file DirectBufferPool.hpp
+    \brief Recycling pool of native-backed direct byte buffers.
+    \author Denis Sorokin
+    \date 05.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // Pool with size classes from 4 KB to 8 MB, keeping up to 4 idle buffers per class:
+* static jh::DirectBufferPool pool(4 * 1024, 8 * 1024 * 1024, 4);
+*
+* // Buffers can be allocated beforehand:
+* pool.preallocate(1920 * 1080 * 4, 3);
+*
+* {
+*     // Take a buffer that is at least 'frameSize' bytes long:
+*     jh::DirectBufferPool::Lease frame = pool.acquire(frameSize);
+*     fillFrame(frame.data(), frame.size());
+*     jh::callMethod<void, jh::DirectBuffer>(someObject, "onFrame", frame);
+*
+* // The buffer returns to the pool here.
+* }
+*
+* // Check how well the pool works:
+* auto statistics = pool.statistics();
+* log("reuse rate: " + std::to_string(statistics.reuseRate()));
+*
+* @endcode
+*/
+
+#ifndef JH_DIRECT_BUFFER_POOL_HPP
+#define JH_DIRECT_BUFFER_POOL_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include <jni.h>
+#include "../buffers/DirectBuffer.hpp"
+
+namespace jh
+{
+    /**
+    * Pool of direct byte buffers grouped by power-of-two size classes. Acquired buffers
+    * are returned to the pool when their lease ends, so the steady-state streaming
+    * allocates neither native memory nor java objects.
+    *
+    * @warning Java code should access pooled buffers with absolute get/put methods (or call
+    * 'clear()' first), because the position and the limit survive the buffer reuse.
+    * @warning The pool should outlive all of its leases.
+    */
+    class DirectBufferPool
+    {
+    public:
+        /**
+        * Counters describing the pool usage.
+        *
+        * @param acquisitions Total number of 'acquire' calls.
+        * @param reuses Number of 'acquire' calls that were served by an idle buffer.
+        * @param allocations Number of direct buffers that were allocated by the pool.
+        * @param leased Number of buffers that are leased right now.
+        * @param highWaterMark Maximum number of buffers that were leased at the same time.
+        */
+        struct Statistics
+        {
+            std::size_t acquisitions;
+            std::size_t reuses;
+            std::size_t allocations;
+            std::size_t leased;
+            std::size_t highWaterMark;
+
+            /**
+            * Returns the share of acquisitions served without allocation, from 0 to 1.
+            */
+            double reuseRate() const
+            {
+                return acquisitions ? static_cast<double>(reuses) / acquisitions : 0.0;
+            }
+        };
+
+        /**
+        * Temporary ownership of one pooled buffer. Returns the buffer to the pool on destruction.
+        * Can be used as 'jh::DirectBuffer' argument in the java calls.
+        */
+        class Lease
+        {
+        public:
+            Lease();
+            Lease(Lease&& other);
+            Lease& operator=(Lease&& other);
+            ~Lease();
+
+            /**
+            * Returns the buffer to the pool before the lease destruction.
+            */
+            void release();
+
+            /**
+            * Pointer to the native memory of the buffer.
+            */
+            void* data() const;
+
+            /**
+            * Number of bytes requested by 'acquire'.
+            */
+            std::size_t size() const;
+
+            /**
+            * Real size of the buffer (size of its class).
+            */
+            std::size_t capacity() const;
+
+            /**
+            * Returns the java byte buffer object.
+            */
+            jobject object() const;
+
+            operator jobject() const;
+            explicit operator bool() const;
+
+        private:
+            friend class DirectBufferPool;
+
+            Lease(DirectBufferPool* pool, std::size_t sizeClass, std::size_t size, DirectBuffer buffer);
+
+            DirectBufferPool* m_pool;
+            std::size_t m_sizeClass;
+            std::size_t m_size;
+            DirectBuffer m_buffer;
+
+            /**
+            * Lease should not be copied.
+            */
+            Lease(const Lease &) = delete;
+            void operator=(const Lease &) = delete;
+        };
+
+        /**
+        * Creates an empty pool.
+        *
+        * @param minBufferSize Size of the smallest size class in bytes.
+        * @param maxBufferSize Size of the largest size class; larger requests are not pooled. Values above
+        * the largest power of two multiple of 'minBufferSize' that fits into size_t are clamped to it.
+        * @param maxIdleBuffersPerClass Maximum number of idle buffers kept for each size class.
+        */
+        DirectBufferPool(std::size_t minBufferSize = 4 * 1024, std::size_t maxBufferSize = 16 * 1024 * 1024, std::size_t maxIdleBuffersPerClass = 4);
+
+        /**
+        * Returns the buffer that is at least 'size' bytes long.
+        */
+        Lease acquire(std::size_t size);
+
+        /**
+        * Allocates idle buffers of the class that fits 'size' bytes.
+        *
+        * @param size Size of the future requests.
+        * @param count Number of buffers to allocate.
+        */
+        void preallocate(std::size_t size, std::size_t count);
+
+        /**
+        * Frees all idle buffers.
+        */
+        void trim();
+
+        /**
+        * Returns the current pool counters.
+        */
+        Statistics statistics() const;
+
+    private:
+        static const std::size_t kUnpooled = static_cast<std::size_t>(-1);
+
+        std::size_t sizeClassOf(std::size_t size) const;
+        std::size_t sizeOfClass(std::size_t sizeClass) const;
+        void giveBack(std::size_t sizeClass, DirectBuffer buffer);
+
+        std::size_t m_minBufferSize;
+        std::size_t m_maxIdleBuffersPerClass;
+
+        mutable std::mutex m_mutex;
+        std::vector<std::vector<DirectBuffer>> m_idleBuffers;
+        Statistics m_statistics;
+
+        /**
+        * Pool should not be copied.
+        */
+        DirectBufferPool(const DirectBufferPool &) = delete;
+        void operator=(const DirectBufferPool &) = delete;
+    };
+}
+
+#endif
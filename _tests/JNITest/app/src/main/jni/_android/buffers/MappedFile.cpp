@@ -0,0 +1,183 @@
+/**
+    \file MappedFile.cpp
+    \brief Memory-mapped files shared with java code as direct byte buffers.
+    \author Denis Sorokin
+    \date 07.03.2016
+*/
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include "../core/ErrorHandler.hpp"
+#include "../core/JNIEnvironment.hpp"
+#include "../calls/InstanceCaller.hpp"
+#include "../buffers/DirectBuffer.hpp"
+#include "../buffers/MappedFile.hpp"
+
+namespace jh
+{
+    namespace
+    {
+        int toAdvice(MappingAccess access)
+        {
+            switch (access) {
+                case MappingAccess::Sequential:
+                    return MADV_SEQUENTIAL;
+                case MappingAccess::Random:
+                    return MADV_RANDOM;
+                case MappingAccess::WillNeed:
+                    return MADV_WILLNEED;
+                default:
+                    return MADV_NORMAL;
+            }
+        }
+    }
+
+    MappedFile::MappedFile()
+    : m_mapping(nullptr)
+    , m_mappingSize(0)
+    , m_pageOffset(0)
+    {
+        // nothing to do here
+    }
+
+    MappedFile::MappedFile(MappedFile&& other)
+    : MappedFile()
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other)
+    {
+        if (&other == this)
+            return *this;
+
+        release();
+
+        std::swap(m_mapping, other.m_mapping);
+        std::swap(m_mappingSize, other.m_mappingSize);
+        std::swap(m_pageOffset, other.m_pageOffset);
+        m_byteBuffer = std::move(other.m_byteBuffer);
+
+        return *this;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        release();
+    }
+
+    void MappedFile::release()
+    {
+        // deleting our global reference doesn't invalidate the byte buffers java still holds:
+        // after munmap any access through them hits an unmapped page and kills the VM with SIGSEGV
+        m_byteBuffer.release();
+
+        if (m_mapping) {
+            munmap(m_mapping, m_mappingSize);
+        }
+
+        m_mapping = nullptr;
+        m_mappingSize = 0;
+        m_pageOffset = 0;
+    }
+
+    bool MappedFile::advise(MappingAccess access)
+    {
+        if (!m_mapping) {
+            return false;
+        }
+
+        return madvise(m_mapping, m_mappingSize, toAdvice(access)) == 0;
+    }
+
+    const void* MappedFile::data() const
+    {
+        return m_mapping ? static_cast<const char*>(m_mapping) + m_pageOffset : nullptr;
+    }
+
+    std::size_t MappedFile::size() const
+    {
+        return m_mappingSize - m_pageOffset;
+    }
+
+    jobject MappedFile::object() const
+    {
+        return m_byteBuffer.get();
+    }
+
+    MappedFile::operator jobject() const
+    {
+        return object();
+    }
+
+    MappedFile::operator bool() const
+    {
+        return object() != nullptr;
+    }
+
+    MappedFile mapFileToJava(const std::string& path, std::size_t offset, std::size_t length, MappingAccess access)
+    {
+        MappedFile result;
+
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            reportInternalError("unable to open file [" + path + "] for mapping");
+            return result;
+        }
+
+        struct stat fileInfo;
+        if (fstat(fd, &fileInfo) != 0 || static_cast<std::size_t>(fileInfo.st_size) <= offset) {
+            reportInternalError("unable to map file [" + path + "] - offset is out of the file");
+            close(fd);
+            return result;
+        }
+
+        std::size_t available = static_cast<std::size_t>(fileInfo.st_size) - offset;
+        if (length == 0 || length > available) {
+            length = available;
+        }
+
+        std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        std::size_t pageOffset = offset % pageSize;
+
+        void* mapping = mmap(nullptr, length + pageOffset, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(offset - pageOffset));
+        close(fd);
+
+        if (mapping == MAP_FAILED) {
+            reportInternalError("unable to map file [" + path + "]");
+            return result;
+        }
+
+        result.m_mapping = mapping;
+        result.m_mappingSize = length + pageOffset;
+        result.m_pageOffset = pageOffset;
+        result.advise(access);
+
+        JNIEnv* env = getCurrentJNIEnvironment();
+
+        jobject byteBuffer = env->NewDirectByteBuffer(static_cast<char*>(mapping) + pageOffset, static_cast<jlong>(length));
+        if (byteBuffer == nullptr) {
+            reportInternalError("unable to create direct buffer for file [" + path + "]");
+            result.release();
+            return result;
+        }
+
+        // the pages are mapped read-only, so java should never write into them
+        jobject readOnlyBuffer = callMethod<DirectBuffer>(byteBuffer, "asReadOnlyBuffer");
+        env->DeleteLocalRef(byteBuffer);
+
+        if (readOnlyBuffer == nullptr) {
+            reportInternalError("unable to create read-only buffer for file [" + path + "]");
+            result.release();
+            return result;
+        }
+
+        result.m_byteBuffer = readOnlyBuffer;
+        env->DeleteLocalRef(readOnlyBuffer);
+
+        return result;
+    }
+}
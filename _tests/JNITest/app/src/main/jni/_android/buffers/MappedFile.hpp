@@ -0,0 +1,131 @@
+/**
+    \file MappedFile.hpp
+    \brief Memory-mapped files shared with java code as direct byte buffers.
+    \author Denis Sorokin
+    \date 07.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // Map the whole file; both C++ and java read the same pages of the page cache:
+* jh::MappedFile assets = jh::mapFileToJava("/data/local/assets.bin");
+*
+* // Map 1 MB starting from the 4 KB offset and tell the kernel it will be read sequentially:
+* jh::MappedFile slice = jh::mapFileToJava(path, 4096, 1024 * 1024, jh::MappingAccess::Sequential);
+*
+* // Read it in C++:
+* auto header = static_cast<const Header*>(assets.data());
+*
+* // Pass it to java as read-only 'java.nio.ByteBuffer':
+* jh::callMethod<void, jh::DirectBuffer>(someObject, "setAssets", assets);
+*
+* // Change the access hint later:
+* assets.advise(jh::MappingAccess::Random);
+*
+* // Unmapped here (or on destruction):
+* assets.release();
+*
+* @endcode
+*/
+
+#ifndef JH_MAPPED_FILE_HPP
+#define JH_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <jni.h>
+#include "../utils/JavaObjectPointer.hpp"
+
+namespace jh
+{
+    /**
+    * Hints about the way the mapped memory is going to be accessed (see madvise).
+    */
+    enum class MappingAccess
+    {
+        Normal,
+        Sequential,
+        Random,
+        WillNeed
+    };
+
+    /**
+    * Read-only memory mapping of a file exposed to java as a read-only direct byte buffer.
+    * The file is unmapped when the object is released or destroyed.
+    * Can be used as 'jh::DirectBuffer' argument in the java calls.
+    *
+    * @warning The mapping must outlive every java reference to its byte buffer. Releasing it
+    * unmaps the pages right away, and the next read through a buffer that java kept (or through
+    * its duplicates and slices) crashes the whole VM with SIGSEGV instead of throwing an exception.
+    * Hand the buffer only to java code with a clear end of use and release the mapping after it.
+    */
+    class MappedFile
+    {
+    public:
+        MappedFile();
+        MappedFile(MappedFile&& other);
+        MappedFile& operator=(MappedFile&& other);
+        ~MappedFile();
+
+        /**
+        * Releases the java byte buffer and unmaps the file. Must be called only after java
+        * stopped using the buffer.
+        */
+        void release();
+
+        /**
+        * Applies the access hint to the whole mapping.
+        *
+        * @return True if the hint was accepted by the kernel or false otherwise.
+        */
+        bool advise(MappingAccess access);
+
+        /**
+        * Pointer to the first mapped byte of the file (the one at the requested offset).
+        */
+        const void* data() const;
+
+        /**
+        * Number of mapped bytes starting from 'data()'.
+        */
+        std::size_t size() const;
+
+        /**
+        * Returns the java byte buffer object.
+        */
+        jobject object() const;
+
+        operator jobject() const;
+        explicit operator bool() const;
+
+    private:
+        friend MappedFile mapFileToJava(const std::string& path, std::size_t offset, std::size_t length, MappingAccess access);
+
+        void* m_mapping;
+        std::size_t m_mappingSize;
+        std::size_t m_pageOffset;
+        JavaObjectPointer m_byteBuffer;
+
+        /**
+        * Mapping should not be copied.
+        */
+        MappedFile(const MappedFile &) = delete;
+        void operator=(const MappedFile &) = delete;
+    };
+
+    /**
+    * Maps the part of the file into memory and wraps it as a read-only java direct byte buffer.
+    *
+    * @param path Path to the file.
+    * @param offset Offset of the first mapped byte; doesn't have to be page-aligned.
+    * @param length Number of bytes to map; zero maps everything up to the end of the file.
+    * @param access Initial access hint.
+    * @return Mapped file; it is empty if mapping failed.
+    */
+    MappedFile mapFileToJava(const std::string& path, std::size_t offset = 0, std::size_t length = 0, MappingAccess access = MappingAccess::Normal);
+}
+
+#endif
@@ -0,0 +1,238 @@
+/**
+    \file SharedRingBuffer.cpp
+    \brief Lock-free ring buffer shared between C++ producers and java consumer.
+    \author Denis Sorokin
+    \date 09.03.2016
+*/
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+#include "../core/ErrorHandler.hpp"
+#include "../core/JNIEnvironment.hpp"
+#include "../calls/InstanceCaller.hpp"
+#include "../calls/ObjectCreation.hpp"
+#include "../native/JavaNativeMethod.hpp"
+#include "../buffers/SharedRingBuffer.hpp"
+
+namespace jh
+{
+    namespace
+    {
+        /**
+        * Records are aligned to this size, so the length header never crosses the ring end.
+        */
+        const std::size_t kRecordAlignment = 8;
+
+        /**
+        * Length of the padding record that fills the space up to the end of the ring.
+        */
+        const std::int32_t kPaddingRecord = -1;
+
+        const std::size_t kLengthSize = sizeof(std::int32_t);
+
+        std::size_t recordSize(std::size_t payloadSize)
+        {
+            return (kLengthSize + payloadSize + kRecordAlignment - 1) / kRecordAlignment * kRecordAlignment;
+        }
+
+        jlong JNICALL nativeAddress(JNIEnv* env, jclass, jobject buffer)
+        {
+            return reinterpret_cast<jlong>(env->GetDirectBufferAddress(buffer));
+        }
+
+        jlong JNICALL nativeLoad(JNIEnv*, jclass, jlong address)
+        {
+            return reinterpret_cast<std::atomic<std::int64_t>*>(address)->load();
+        }
+
+        void JNICALL nativeStore(JNIEnv*, jclass, jlong address, jlong value)
+        {
+            reinterpret_cast<std::atomic<std::int64_t>*>(address)->store(value);
+        }
+
+        bool registerReaderNatives()
+        {
+            JNINativeMethod methods[] = {
+                makeNativeMethod("nativeAddress", "(Ljava/nio/ByteBuffer;)J", (void*)&nativeAddress),
+                makeNativeMethod("nativeLoad", "(J)J", (void*)&nativeLoad),
+                makeNativeMethod("nativeStore", "(JJ)V", (void*)&nativeStore)
+            };
+
+            return registerJavaNativeMethods(SharedRingBuffer::className(), 3, methods);
+        }
+    }
+
+    /**
+    * Layout of the shared header; keep in sync with com.jnihelper.SharedRingBuffer.
+    * The data area starts right after the header.
+    */
+    struct SharedRingBuffer::Header
+    {
+        alignas(64) std::int64_t capacity;
+        alignas(64) std::atomic<std::int64_t> head;
+        alignas(64) std::atomic<std::int64_t> tail;
+        alignas(64) std::atomic<std::int64_t> reserved;
+        alignas(64) std::atomic<std::int64_t> consumerWaiting;
+    };
+
+    static_assert(sizeof(std::atomic<std::int64_t>) == sizeof(std::int64_t), "atomic counters should have no extra state");
+
+    SharedRingBuffer::SharedRingBuffer(std::size_t capacity, RingProducers producers)
+    : m_header(nullptr)
+    , m_data(nullptr)
+    , m_capacity(kRecordAlignment)
+    , m_producers(producers)
+    {
+        static std::once_flag nativesRegistration;
+        static bool nativesRegistered = false;
+        std::call_once(nativesRegistration, [] { nativesRegistered = registerReaderNatives(); });
+
+        if (!nativesRegistered) {
+            reportInternalError("shared ring buffer reader natives are not registered");
+            return;
+        }
+
+        while (m_capacity < capacity) {
+            m_capacity <<= 1;
+        }
+
+        void* memory = nullptr;
+        if (posix_memalign(&memory, alignof(Header), sizeof(Header) + m_capacity) != 0) {
+            reportInternalError("unable to allocate shared ring buffer memory");
+            return;
+        }
+
+        m_header = new (memory) Header();
+        m_header->capacity = static_cast<std::int64_t>(m_capacity);
+        m_data = static_cast<char*>(memory) + sizeof(Header);
+
+        m_buffer = DirectBuffer(memory, sizeof(Header) + m_capacity, [] (void* data) {
+            free(data);
+        });
+
+        if (m_buffer) {
+            jobject reader = createNewObject<DirectBuffer>(className(), m_buffer);
+            m_reader = reader;
+            getCurrentJNIEnvironment()->DeleteLocalRef(reader);
+        }
+    }
+
+    bool SharedRingBuffer::publish(const void* data, std::size_t size)
+    {
+        if (!reader()) {
+            return false;
+        }
+
+        const std::size_t needed = recordSize(size);
+        if (needed > m_capacity) {
+            reportInternalError("record is larger than the shared ring buffer");
+            return false;
+        }
+
+        std::int64_t start;
+        std::size_t padding;
+        std::size_t reservation;
+
+        // reserve the space; single producer owns the head, multiple producers race for 'reserved'
+        std::atomic<std::int64_t>& cursor = m_producers == RingProducers::Single ? m_header->head : m_header->reserved;
+        start = cursor.load(std::memory_order_relaxed);
+
+        while (true) {
+            std::size_t index = static_cast<std::size_t>(start) & (m_capacity - 1);
+            padding = index + needed > m_capacity ? m_capacity - index : 0;
+            reservation = padding + needed;
+
+            std::int64_t freeSpace = static_cast<std::int64_t>(m_capacity) - (start - m_header->tail.load(std::memory_order_acquire));
+            if (static_cast<std::int64_t>(reservation) > freeSpace) {
+                // the record may never fit between the padding and the tail (even in an empty ring),
+                // so only the padding is published and the retry starts at the beginning of the ring
+                if (padding == 0 || static_cast<std::int64_t>(padding) > freeSpace) {
+                    return false;
+                }
+                reservation = padding;
+            }
+
+            if (m_producers == RingProducers::Single) {
+                break;
+            }
+
+            if (cursor.compare_exchange_weak(start, start + static_cast<std::int64_t>(reservation), std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        std::size_t index = static_cast<std::size_t>(start) & (m_capacity - 1);
+
+        if (padding) {
+            std::memcpy(m_data + index, &kPaddingRecord, kLengthSize);
+            index = 0;
+        }
+
+        const bool recordFits = reservation == padding + needed;
+        if (recordFits) {
+            std::int32_t length = static_cast<std::int32_t>(size);
+            std::memcpy(m_data + index, &length, kLengthSize);
+            std::memcpy(m_data + index + kLengthSize, data, size);
+        }
+
+        const std::int64_t end = start + static_cast<std::int64_t>(reservation);
+
+        if (m_producers == RingProducers::Multiple) {
+            // records become visible in the reservation order
+            while (m_header->head.load(std::memory_order_acquire) != start) {
+                std::this_thread::yield();
+            }
+        }
+
+        m_header->head.store(end, std::memory_order_release);
+
+        return recordFits;
+    }
+
+    void SharedRingBuffer::notifyConsumer()
+    {
+        if (!reader()) {
+            return;
+        }
+
+        // pairs with the consumer that raises the flag and then re-reads the head
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (m_header->consumerWaiting.load() != 0) {
+            callMethod<void>(m_reader, "wakeUp");
+        }
+    }
+
+    std::size_t SharedRingBuffer::pendingBytes() const
+    {
+        if (!m_header) {
+            return 0;
+        }
+
+        return static_cast<std::size_t>(m_header->head.load(std::memory_order_acquire) - m_header->tail.load(std::memory_order_acquire));
+    }
+
+    std::size_t SharedRingBuffer::capacity() const
+    {
+        return m_header ? m_capacity : 0;
+    }
+
+    jobject SharedRingBuffer::reader() const
+    {
+        return m_reader.get();
+    }
+
+    SharedRingBuffer::operator jobject() const
+    {
+        return reader();
+    }
+
+    SharedRingBuffer::operator bool() const
+    {
+        return reader() != nullptr;
+    }
+}
@@ -33,6 +33,8 @@
 #include <string>
 #include "../core/ErrorHandler.hpp"
 #include "../core/JNIEnvironment.hpp"
+#include "../calls/JavaCallProfiler.hpp"
+#include "../calls/JavaMethodCache.hpp"
 #include "../core/JavaMethodSignature.hpp"
 
 namespace jh
@@ -73,6 +75,42 @@ namespace jh
         }
     };
 
+    /**
+    * Class that can call methods which return jbyte values.
+    */
+    template<class ... ArgumentTypes>
+    struct InstanceCaller<jbyte, ArgumentTypes...>
+    {
+        static jbyte call(JNIEnv* env, jobject instance, jmethodID javaMethod, ArgumentTypes ... arguments)
+        {
+            return env->CallByteMethod(instance, javaMethod, arguments...);
+        }
+    };
+
+    /**
+    * Class that can call methods which return jchar values.
+    */
+    template<class ... ArgumentTypes>
+    struct InstanceCaller<jchar, ArgumentTypes...>
+    {
+        static jchar call(JNIEnv* env, jobject instance, jmethodID javaMethod, ArgumentTypes ... arguments)
+        {
+            return env->CallCharMethod(instance, javaMethod, arguments...);
+        }
+    };
+
+    /**
+    * Class that can call methods which return jshort values.
+    */
+    template<class ... ArgumentTypes>
+    struct InstanceCaller<jshort, ArgumentTypes...>
+    {
+        static jshort call(JNIEnv* env, jobject instance, jmethodID javaMethod, ArgumentTypes ... arguments)
+        {
+            return env->CallShortMethod(instance, javaMethod, arguments...);
+        }
+    };
+
     /**
     * Class that can call methods which return jint values.
     */
@@ -136,22 +174,19 @@ namespace jh
         using RealReturnType = typename ToJavaType<ReturnType>::Type;
 
         JNIEnv* env = getCurrentJNIEnvironment();
+        JavaCallTimer timer;
 
         std::string methodSignature = getJavaMethodSignature<ReturnType, ArgumentTypes...>();
 
-        jclass javaClass = env->GetObjectClass(instance);
-        if (javaClass == nullptr) {
-            reportInternalError("class for java object instance not found");
-            return RealReturnType();
-        }
-
-        jmethodID javaMethod = env->GetMethodID(javaClass, methodName.c_str(), methodSignature.c_str());
+        // the class of the object is only compared with the cached ones, no method lookup is made after the first call
+        const JavaMethodEntry* javaMethod = findJavaInstanceMethod(env, instance, methodName, methodSignature);
         if (javaMethod == nullptr) {
-            reportInternalError("method [" + methodName + "] for java object instance not found, tried signature [" + methodSignature + "]");
             return RealReturnType();
         }
 
-        return static_cast<RealReturnType>(InstanceCaller<typename ToJavaType<ReturnType>::CallReturnType, typename ToJavaType<ArgumentTypes>::Type ...>::call(env, instance, javaMethod, arguments...));
+        timer.lookupFinished(javaMethod);
+
+        return static_cast<RealReturnType>(InstanceCaller<typename ToJavaType<ReturnType>::CallReturnType, typename ToJavaType<ArgumentTypes>::Type ...>::call(env, instance, javaMethod->method, arguments...));
     }
 }
 
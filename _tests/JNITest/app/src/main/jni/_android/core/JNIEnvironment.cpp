@@ -9,6 +9,7 @@
 #include "../../zframework/core/_android/jnienv.h"
 #include "../core/JNIEnvironment.hpp"
 #include "../core/ErrorHandler.hpp"
+#include "../core/Statistics.hpp"
 
 namespace jh
 {
@@ -31,6 +32,18 @@ namespace jh
         return env;
     }
 
+    JNIEnv* tryGetCurrentJNIEnvironment()
+    {
+        JNIEnv* env = nullptr;
+        JavaVM* javaVM = getJavaVM();
+
+        if (javaVM == nullptr || javaVM->GetEnv((void**)&env, JNI_VERSION_1_6) != JNI_OK) {
+            return nullptr;
+        }
+
+        return env;
+    }
+
     JNIEnvironmentGuarantee::JNIEnvironmentGuarantee()
     : m_threadShouldBeDetached(false)
     {
@@ -44,6 +57,7 @@ namespace jh
                 reportInternalError("couldn't attach current thread to java VM");
             } else {
                 m_threadShouldBeDetached = true;
+                countStatistic(Statistic::ThreadAttaches);
                 // no classes besides the system ones!
                 // TODO : do something with this
             }
@@ -58,6 +72,7 @@ namespace jh
     {
         if (m_threadShouldBeDetached) {
             getJavaVM()->DetachCurrentThread();
+            countStatistic(Statistic::ThreadDetaches);
         }
     }
 }
@@ -52,6 +52,13 @@ namespace jh
     */
     JNIEnv* getCurrentJNIEnvironment();
 
+    /**
+    * Returns the JNI environment pointer for the current thread without reporting errors.
+    *
+    * @return JNIEnv pointer or nullptr if the thread is not attached to the JVM.
+    */
+    JNIEnv* tryGetCurrentJNIEnvironment();
+
     /**
     * Utility class that ensures that JNI environment pointer exists while the object
     * of this class is alive. Right now, it attaches the current thread to the JVM if
@@ -0,0 +1,113 @@
+/**
+    \file Statistics.hpp
+    \brief Global counters of the JNI work done by the library.
+    \author Denis Sorokin
+    \date 24.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // Snapshot of all counters; they are never reset, so exporters should report the differences:
+* jh::Statistics statistics = jh::stats();
+* metrics.gauge("jni.global_refs", statistics.liveGlobalReferences);
+* metrics.counter("jni.bytes_to_java", statistics.bytesToJava);
+*
+* @endcode
+*/
+
+#ifndef JH_STATISTICS_HPP
+#define JH_STATISTICS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace jh
+{
+    /**
+    * Snapshot of the library counters. Counters are updated independently,
+    * so the snapshot is not atomic as a whole.
+    */
+    struct Statistics
+    {
+        std::uint64_t classLookups;            ///< 'FindClass' calls.
+        std::uint64_t memberLookups;           ///< 'GetMethodID', 'GetStaticMethodID' and 'GetFieldID' calls.
+        std::uint64_t methodCacheHits;         ///< Java calls that found their method in the cache.
+        std::uint64_t methodCacheMisses;       ///< Java calls that had to look up their method.
+        std::int64_t liveGlobalReferences;     ///< Global references owned by JavaObjectPointer, SharedJavaObject and GlobalRef.
+        std::int64_t liveWeakReferences;       ///< Weak global references owned by WeakRef.
+        std::uint64_t peakLocalFrameCapacity;  ///< Largest local frame or local capacity requested at once.
+        std::uint64_t threadAttaches;          ///< Threads attached by JNIEnvironmentGuarantee.
+        std::uint64_t threadDetaches;          ///< Threads detached by JNIEnvironmentGuarantee.
+        std::uint64_t objectsCreated;          ///< Java objects created by 'createNewObject'.
+        std::uint64_t stringsCreated;          ///< Java strings created by 'createJString' and string arrays.
+        std::uint64_t arraysCreated;           ///< Java arrays created by JavaArrayBuilder and other array utilities.
+        std::uint64_t bytesToJava;             ///< Bytes of array elements and string characters copied to java.
+        std::uint64_t bytesFromJava;           ///< Bytes of array elements and string characters copied from java.
+    };
+
+    /**
+    * @return Current values of all counters.
+    */
+    Statistics stats();
+
+    /**
+    * Counters behind 'Statistics'. They should not be used by the programmer itself.
+    */
+    enum class Statistic
+    {
+        ClassLookups,
+        MemberLookups,
+        MethodCacheHits,
+        MethodCacheMisses,
+        LiveGlobalReferences,
+        LiveWeakReferences,
+        PeakLocalFrameCapacity,
+        ThreadAttaches,
+        ThreadDetaches,
+        ObjectsCreated,
+        StringsCreated,
+        ArraysCreated,
+        BytesToJava,
+        BytesFromJava,
+        Count
+    };
+
+    /**
+    * Every counter takes its own cache line, so threads that update different counters don't interfere.
+    */
+    inline std::atomic<std::int64_t>& statisticCounter(Statistic statistic)
+    {
+        struct alignas(64) Counter
+        {
+            std::atomic<std::int64_t> value;
+        };
+
+        static Counter counters[static_cast<std::size_t>(Statistic::Count)] = {};
+
+        return counters[static_cast<std::size_t>(statistic)].value;
+    }
+
+    inline void countStatistic(Statistic statistic, std::int64_t value = 1)
+    {
+        statisticCounter(statistic).fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+    * Raises the counter to the value if it is lower.
+    */
+    inline void raiseStatistic(Statistic statistic, std::int64_t value)
+    {
+        std::atomic<std::int64_t>& counter = statisticCounter(statistic);
+
+        std::int64_t current = counter.load(std::memory_order_relaxed);
+        while (value > current && !counter.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+            // current is updated by the failed exchange
+        }
+    }
+}
+
+#endif
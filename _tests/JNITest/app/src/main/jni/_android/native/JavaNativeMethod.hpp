@@ -23,12 +23,43 @@
 #ifndef JH_JAVA_NATIVE_METHOD_HPP
 #define JH_JAVA_NATIVE_METHOD_HPP
 
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
 #include <jni.h>
+#include "../core/ToJavaType.hpp"
 #include "../core/ErrorHandler.hpp"
 #include "../core/JavaMethodSignature.hpp"
+#include "../native/NativeArgument.hpp"
+#include "../native/NativeMethodStats.hpp"
 
 namespace jh
 {
+    /**
+    * Small utility structure to hold information about java native methods.
+    *
+    * @param name Name of the java native method.
+    * @param signature Full signature of the java native method.
+    * @param pointer A pointer to the C++ function that should be called as native method.
+    */
+    struct NativeMethodDescription
+    {
+        std::string name;
+        std::string signature;
+        void* pointer;
+    };
+
+    /**
+    * Makes the JNI description of a native method. Names are 'const char*' in the android jni.h,
+    * but 'char*' in the desktop one, so the descriptions are only made here.
+    */
+    inline JNINativeMethod makeNativeMethod(const char* name, const char* signature, void* pointer)
+    {
+        return {const_cast<char*>(name), const_cast<char*>(signature), pointer};
+    }
+
     /**
     * Registers local functions as java native methods.
     *
@@ -41,7 +72,72 @@ namespace jh
     * @warning Java native methods should be registered only after JNI initialization, i.e. dont use this method while doing some static-level stuff.
     * @warning Don't call native methods from java until they are 100% registered in C++. There will be a crash if they aren't.
     */
-    bool registerJavaNativeMethods(std::string javaClassName, int methodCount, JNINativeMethod* methodDescriptions);
+    bool registerJavaNativeMethods(std::string javaClassName, int methodCount, const JNINativeMethod* methodDescriptions);
+
+#ifdef JH_NATIVE_METHOD_STATS
+    /**
+    * Counted native functions for the static native methods with the same signature.
+    * There is a fixed number of them, because every one needs its own function and
+    * JNI passes nothing that tells which of the methods was called.
+    * It should not be used by the programmer itself, but by registerStaticNativeMethod.
+    */
+    template<class ReturnType, class ... ArgumentTypes>
+    class StaticNativeThunk
+    {
+    public:
+        using FunctionPointer = ReturnType (*)(ArgumentTypes...);
+
+        static const int kThunkCount = 16;
+
+        /**
+        * Binds the function to the next free native function.
+        *
+        * @return Native function or nullptr if all of them are taken (the function will not be counted).
+        */
+        static void* bind(FunctionPointer function, std::size_t statsSlot)
+        {
+            static std::mutex mutex;
+            static int usedThunks = 0;
+
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (usedThunks == kThunkCount) {
+                reportInternalError("too many counted static native methods with the same signature");
+                return nullptr;
+            }
+
+            int index = usedThunks++;
+            s_functions[index] = function;
+            s_statsSlots[index] = statsSlot;
+
+            void* thunks[kThunkCount] = {
+                (void*)&rawNativeMethod<0>, (void*)&rawNativeMethod<1>, (void*)&rawNativeMethod<2>, (void*)&rawNativeMethod<3>,
+                (void*)&rawNativeMethod<4>, (void*)&rawNativeMethod<5>, (void*)&rawNativeMethod<6>, (void*)&rawNativeMethod<7>,
+                (void*)&rawNativeMethod<8>, (void*)&rawNativeMethod<9>, (void*)&rawNativeMethod<10>, (void*)&rawNativeMethod<11>,
+                (void*)&rawNativeMethod<12>, (void*)&rawNativeMethod<13>, (void*)&rawNativeMethod<14>, (void*)&rawNativeMethod<15>
+            };
+
+            return thunks[index];
+        }
+
+    private:
+        static FunctionPointer s_functions[kThunkCount];
+        static std::size_t s_statsSlots[kThunkCount];
+
+        template<int index>
+        static ReturnType rawNativeMethod(JNIEnv*, jclass, ArgumentTypes ... args)
+        {
+            JH_NATIVE_METHOD_TIMER(s_statsSlots[index]);
+            return s_functions[index](args...);
+        }
+    };
+
+    template<class ReturnType, class ... ArgumentTypes>
+    typename StaticNativeThunk<ReturnType, ArgumentTypes...>::FunctionPointer StaticNativeThunk<ReturnType, ArgumentTypes...>::s_functions[kThunkCount];
+
+    template<class ReturnType, class ... ArgumentTypes>
+    std::size_t StaticNativeThunk<ReturnType, ArgumentTypes...>::s_statsSlots[kThunkCount];
+#endif
 
     /**
     * Registers some function or static method as a java native static method.
@@ -57,11 +153,17 @@ namespace jh
     bool registerStaticNativeMethod(std::string javaClassName, std::string methodName, ReturnType (*methodPointer)(ArgumentTypes...))
     {
         std::string signature = getJavaMethodSignature<ReturnType, ArgumentTypes...>();
+        void* nativeFunction = (void*)methodPointer;
+
+#ifdef JH_NATIVE_METHOD_STATS
+        std::size_t statsSlot = registerNativeMethodStatsSlot(javaClassName, methodName);
+        if (void* thunk = StaticNativeThunk<ReturnType, ArgumentTypes...>::bind(methodPointer, statsSlot)) {
+            nativeFunction = thunk;
+        }
+#endif
 
         JNINativeMethod method[1] = {
-            methodName.c_str(),
-            signature.c_str(),
-            (void*)methodPointer
+            makeNativeMethod(methodName.c_str(), signature.c_str(), nativeFunction)
         };
 
         return registerJavaNativeMethods(javaClassName, 1, method);
@@ -106,17 +208,24 @@ namespace jh
         using MethodImplementationPointer = ReturnType(CppClass::*)(Arguments...);
 
         /**
-        * Java object wrapper should freely access native method.
+        * Java object wrapper and native peer should freely access native method.
         */
         template <class, class>
         friend class JavaObjectWrapper;
 
+        template <class, class>
+        friend class JavaNativePeer;
+
     private:
         /**
         * Native method pointer is stored here.
         */
         static MethodImplementationPointer s_callback;
 
+#ifdef JH_NATIVE_METHOD_STATS
+        static std::size_t s_statsSlot;
+#endif
+
         /**
         * Sets the native method pointer. Should be called once (no less, no more) per native method.
         */
@@ -129,19 +238,125 @@ namespace jh
             s_callback = callback;
         }
 
+        /**
+        * Reserves the statistics slot; does nothing if JH_NATIVE_METHOD_STATS is not defined.
+        */
+        static void linkStats(const std::string& methodName)
+        {
+#ifdef JH_NATIVE_METHOD_STATS
+            s_statsSlot = registerNativeMethodStatsSlot(CppClass::JavaClass::className(), methodName);
+#else
+            (void)methodName;
+#endif
+        }
+
         /**
         * Static method that is used to link java native method and local instance method.
         */
-        static ReturnType rawNativeMethod(JNIEnv*, jobject javaObject, Arguments ... args)
+        static ReturnType rawNativeMethod(JNIEnv* env, jobject javaObject, Arguments ... args)
         {
-            return CppClass::template callCppObjectMethod<ReturnType>(javaObject, [=] (CppClass* wrapperInstance) -> ReturnType {
+            JH_NATIVE_METHOD_TIMER(s_statsSlot);
+
+            if (CppClass* wrapperInstance = CppClass::findCppObject(env, javaObject)) {
                 return (wrapperInstance->*s_callback)(args...);
-            });
+            }
+
+            return ReturnType();
         }
     };
 
     template<int id, class CppClass, class ReturnType, class ... Arguments>
     typename JavaNativeMethod<id, CppClass, ReturnType, Arguments...>::MethodImplementationPointer JavaNativeMethod<id, CppClass, ReturnType, Arguments...>::s_callback(nullptr);
+
+#ifdef JH_NATIVE_METHOD_STATS
+    template<int id, class CppClass, class ReturnType, class ... Arguments>
+    std::size_t JavaNativeMethod<id, CppClass, ReturnType, Arguments...>::s_statsSlot(0);
+#endif
+
+#if __cplusplus >= 201703L
+    /**
+    * This class provides an static method that should be registered as java native method.
+    * Unlike JavaNativeMethod it takes the C++ method as a template argument, so there
+    * is no id, no callback to set and no indirect call. Arguments and results of the
+    * C++ method can be any types supported by NativeArgument and NativeResult.
+    * It should not be used by the programmer itself, but by the JavaObjectWrapper class.
+    *
+    * @param Method Pointer to the method of the class that wraps some Java class.
+    */
+    template<auto Method>
+    class JavaNativeThunk;
+
+    template<class CppClass, class ReturnType, class ... Arguments, ReturnType (CppClass::*Method)(Arguments...)>
+    class JavaNativeThunk<Method>
+    {
+        /**
+        * Java object wrapper and native peer should freely access native method.
+        */
+        template <class, class>
+        friend class JavaObjectWrapper;
+
+        template <class, class>
+        friend class JavaNativePeer;
+
+        /**
+        * JNI types of the native method; C++ types are converted with NativeArgument and NativeResult.
+        */
+        using JavaReturnType = typename NativeResult<ReturnType>::JavaType;
+
+    private:
+#ifdef JH_NATIVE_METHOD_STATS
+        inline static std::size_t s_statsSlot = 0;
+#endif
+
+        /**
+        * Reserves the statistics slot; does nothing if JH_NATIVE_METHOD_STATS is not defined.
+        */
+        static void linkStats(const std::string& methodName)
+        {
+#ifdef JH_NATIVE_METHOD_STATS
+            s_statsSlot = registerNativeMethodStatsSlot(CppClass::JavaClass::className(), methodName);
+#else
+            (void)methodName;
+#endif
+        }
+
+        /**
+        * Java signature of the native method; deduced from the C++ method if no java types are given.
+        */
+        template<class ... JavaTypes>
+        static std::string signature()
+        {
+            if constexpr (sizeof...(JavaTypes) == 0) {
+                return getJavaMethodSignature<typename NativeResult<ReturnType>::SignatureType, typename NativeArgumentFor<Arguments>::SignatureType...>();
+            } else {
+                static_assert(std::is_same<std::tuple<typename ToJavaType<JavaTypes>::Type...>, std::tuple<JavaReturnType, typename NativeArgumentFor<Arguments>::JavaType...>>::value,
+                              "java types should correspond to the C++ method signature");
+
+                return getJavaMethodSignature<JavaTypes...>();
+            }
+        }
+
+        /**
+        * Static method that is used to link java native method and local instance method.
+        * Converted arguments live until the C++ method returns (and its result is converted).
+        */
+        static JavaReturnType rawNativeMethod(JNIEnv* env, jobject javaObject, typename NativeArgumentFor<Arguments>::JavaType ... args)
+        {
+            JH_NATIVE_METHOD_TIMER(s_statsSlot);
+
+            CppClass* wrapperInstance = CppClass::findCppObject(env, javaObject);
+            if (!wrapperInstance) {
+                return JavaReturnType();
+            }
+
+            if constexpr (std::is_void<ReturnType>::value) {
+                (wrapperInstance->*Method)(NativeArgumentFor<Arguments>(env, args).get()...);
+            } else {
+                return NativeResult<ReturnType>::toJava(env, (wrapperInstance->*Method)(NativeArgumentFor<Arguments>(env, args).get()...));
+            }
+        }
+    };
+#endif
 }
 
 #endif
@@ -0,0 +1,202 @@
+/**
+    \file JavaNativePeer.cpp
+    \brief C++ peers of java objects that are created and owned by java.
+    \author Denis Sorokin
+    \date 21.03.2016
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include "../core/ErrorHandler.hpp"
+#include "../core/Statistics.hpp"
+#include "../core/JNIEnvironment.hpp"
+#include "../native/JavaNativePeer.hpp"
+#include "../utils/JavaReferences.hpp"
+
+namespace jh
+{
+    PeerSlab::PeerSlab(std::size_t blockSize, std::size_t blocksPerChunk)
+    : m_blockSize((blockSize + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t))
+    , m_blocksPerChunk(blocksPerChunk > 0 ? blocksPerChunk : 1)
+    , m_freeBlocks(nullptr)
+    , m_pooled(0)
+    , m_live(0)
+    {
+        // nothing to do here
+    }
+
+    PeerSlab::~PeerSlab()
+    {
+        for (void* chunk : m_chunks) {
+            ::operator delete(chunk);
+        }
+    }
+
+    void* PeerSlab::allocate()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!m_freeBlocks) {
+            char* chunk = static_cast<char*>(::operator new(m_blockSize * m_blocksPerChunk, std::nothrow));
+            if (!chunk) {
+                reportInternalError("unable to allocate the chunk of native peers");
+                return nullptr;
+            }
+
+            m_chunks.push_back(chunk);
+
+            // blocks are taken in the address order
+            for (std::size_t i = m_blocksPerChunk; i > 0; --i) {
+                FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + (i - 1) * m_blockSize);
+                block->next = m_freeBlocks;
+                m_freeBlocks = block;
+            }
+            m_pooled += m_blocksPerChunk;
+        }
+
+        FreeBlock* block = m_freeBlocks;
+        m_freeBlocks = block->next;
+        --m_pooled;
+        ++m_live;
+
+        return block;
+    }
+
+    void PeerSlab::deallocate(void* block)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+        freeBlock->next = m_freeBlocks;
+        m_freeBlocks = freeBlock;
+        ++m_pooled;
+        --m_live;
+    }
+
+    PeerSlabStatistics PeerSlab::statistics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return {m_live, m_pooled, m_chunks.size()};
+    }
+
+    namespace
+    {
+        const char* const kNativePeerClassName = "com/jnihelper/NativePeer";
+
+        /**
+        * Registered peer classes; entries are only appended and are published by the
+        * count, so the factories are found without locks.
+        */
+        const std::size_t kMaxPeerClasses = 64;
+
+        struct PeerFactoryEntry
+        {
+            jclass javaClass;
+            NativePeerFactory factory;
+        };
+
+        PeerFactoryEntry peerFactories[kMaxPeerClasses];
+        std::atomic<std::size_t> peerFactoriesCount(0);
+        std::mutex peerFactoriesMutex;
+
+        std::once_flag nativePeerRegistration;
+        bool nativePeerWasRegistered = false;
+        jfieldID nativeHandleField = nullptr;
+
+        jlong createPeer(JNIEnv* env, jclass, jobject javaObject, jclass javaClass)
+        {
+            std::size_t count = peerFactoriesCount.load(std::memory_order_acquire);
+
+            for (std::size_t i = 0; i < count; ++i) {
+                if (env->IsSameObject(javaClass, peerFactories[i].javaClass)) {
+                    return peerFactories[i].factory(env, javaObject);
+                }
+            }
+
+            reportInternalError("couldn't create native peer - its java class is not registered");
+
+            return 0;
+        }
+
+        void destroyPeer(JNIEnv*, jclass, jlong handle)
+        {
+            void* block = reinterpret_cast<void*>(static_cast<std::intptr_t>(handle));
+            (*static_cast<NativePeerDestroyFunction*>(block))(block);
+        }
+
+        void registerNativePeerClass()
+        {
+            JNIEnv* env = getCurrentJNIEnvironment();
+
+            countStatistic(Statistic::ClassLookups);
+
+            LocalRef<jclass> javaClass(env->FindClass(kNativePeerClassName));
+            if (!javaClass) {
+                env->ExceptionClear();
+                reportInternalError("java class [" + std::string(kNativePeerClassName) + "] not found, native peers are disabled");
+                return;
+            }
+
+            countStatistic(Statistic::MemberLookups);
+            nativeHandleField = env->GetFieldID(javaClass, "nativeHandle", "J");
+            if (!nativeHandleField) {
+                env->ExceptionClear();
+                reportInternalError("long field [nativeHandle] not found in java class [" + std::string(kNativePeerClassName) + "]");
+                return;
+            }
+
+            JNINativeMethod methods[] = {
+                makeNativeMethod("createPeer", "(Lcom/jnihelper/NativePeer;Ljava/lang/Class;)J", (void*)&createPeer),
+                makeNativeMethod("destroyPeer", "(J)V", (void*)&destroyPeer)
+            };
+
+            if (env->RegisterNatives(javaClass, methods, 2) < 0) {
+                env->ExceptionClear();
+                reportInternalError("unable to register native methods for class [" + std::string(kNativePeerClassName) + "]");
+                return;
+            }
+
+            nativePeerWasRegistered = true;
+        }
+    }
+
+    bool registerNativePeerFactory(const std::string& javaClassName, NativePeerFactory factory)
+    {
+        std::call_once(nativePeerRegistration, registerNativePeerClass);
+        if (!nativePeerWasRegistered) {
+            return false;
+        }
+
+        JNIEnv* env = getCurrentJNIEnvironment();
+
+        countStatistic(Statistic::ClassLookups);
+
+        LocalRef<jclass> javaClass(env->FindClass(javaClassName.c_str()));
+        if (!javaClass) {
+            env->ExceptionClear();
+            reportInternalError("unable to find class [" + javaClassName + "] for native peer registration");
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(peerFactoriesMutex);
+
+        std::size_t count = peerFactoriesCount.load(std::memory_order_relaxed);
+        if (count == kMaxPeerClasses) {
+            reportInternalError("too many native peer classes, unable to register [" + javaClassName + "]");
+            return false;
+        }
+
+        peerFactories[count].javaClass = static_cast<jclass>(env->NewGlobalRef(javaClass));
+        peerFactories[count].factory = factory;
+        peerFactoriesCount.store(count + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    jfieldID nativePeerHandleField()
+    {
+        return nativeHandleField;
+    }
+}
@@ -0,0 +1,372 @@
+/**
+    \file JavaNativePeer.hpp
+    \brief C++ peers of java objects that are created and owned by java.
+    \author Denis Sorokin
+    \date 21.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.java}
+*
+* // Java class extends com.jnihelper.NativePeer; the C++ peer is created by its constructor:
+* package com.some.path;
+*
+* public class Counter extends com.jnihelper.NativePeer
+* {
+*     public native int increment();
+* }
+*
+* // The peer is destroyed by 'close()' or, if it wasn't called, after the object is collected:
+* try (Counter counter = new Counter()) {
+*     counter.increment();
+* }
+*
+* @endcode
+*
+* @code{.cpp}
+*
+* JH_JAVA_CUSTOM_CLASS(JavaCounter, "com/some/path/Counter");
+*
+* class Counter : public jh::JavaNativePeer<JavaCounter, Counter>
+* {
+* public:
+*     // Called once by 'registerPeerClass', same as for the wrapper classes:
+*     static void linkJavaNativeMethods()
+*     {
+*         registerNativeMethod<&Counter::increment>("increment");
+*
+*         // C++11 version:
+*         //     registerNativeMethod<1, int>("increment", &Counter::increment);
+*     }
+*
+*     int increment() { return ++m_value; }
+*
+* private:
+*     int m_value = 0;
+* };
+*
+* // Before the first java object is created:
+* Counter::registerPeerClass();
+*
+* // Peers are allocated from the per-class slab:
+* jh::PeerSlabStatistics statistics = Counter::peerStatistics();
+*
+* @endcode
+*/
+
+#ifndef JH_JAVA_NATIVE_PEER_HPP
+#define JH_JAVA_NATIVE_PEER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <jni.h>
+#include "../core/ToJavaType.hpp"
+#include "../core/ErrorHandler.hpp"
+#include "../native/JavaNativeMethod.hpp"
+#include "../utils/JavaReferences.hpp"
+
+namespace jh
+{
+    /**
+    * Usage of the peer slab.
+    *
+    * @param live Number of peers that were created and not destroyed yet.
+    * @param pooled Number of free blocks that are ready for the new peers.
+    * @param chunks Number of chunks that were allocated by the slab.
+    */
+    struct PeerSlabStatistics
+    {
+        std::size_t live;
+        std::size_t pooled;
+        std::size_t chunks;
+    };
+
+    /**
+    * Pool of the fixed size memory blocks. Blocks are allocated by chunks and are never
+    * returned to the system while the slab exists, so creating and destroying peers
+    * costs a free list pop and push instead of a heap allocation.
+    */
+    class PeerSlab
+    {
+    public:
+        /**
+        * @param blockSize Size of one block; rounded up to the fundamental alignment.
+        * @param blocksPerChunk Number of blocks that are allocated at once.
+        */
+        PeerSlab(std::size_t blockSize, std::size_t blocksPerChunk);
+        ~PeerSlab();
+
+        /**
+        * @return Memory block or nullptr if the chunk couldn't be allocated (the error is already reported).
+        */
+        void* allocate();
+
+        /**
+        * Returns the block to the pool; the block should be allocated by this slab.
+        */
+        void deallocate(void* block);
+
+        PeerSlabStatistics statistics() const;
+
+    private:
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+
+        std::size_t m_blockSize;
+        std::size_t m_blocksPerChunk;
+
+        mutable std::mutex m_mutex;
+        FreeBlock* m_freeBlocks;
+        std::size_t m_pooled;
+        std::size_t m_live;
+        std::vector<void*> m_chunks;
+
+        /**
+        * Slab should not be copied.
+        */
+        PeerSlab(const PeerSlab &) = delete;
+        void operator=(const PeerSlab &) = delete;
+    };
+
+    /**
+    * Functions that java calls through com.jnihelper.NativePeer.
+    * The handle points to the peer block, which starts with its destroy function.
+    */
+    using NativePeerFactory = jlong (*)(JNIEnv* env, jobject javaObject);
+    using NativePeerDestroyFunction = void (*)(void* block);
+
+    /**
+    * Registers the factory of the java class and, on the first call, the native methods
+    * of com.jnihelper.NativePeer. It should not be used by the programmer itself.
+    *
+    * @return True if java objects of this class can create their peers.
+    */
+    bool registerNativePeerFactory(const std::string& javaClassName, NativePeerFactory factory);
+
+    /**
+    * ID of the 'long nativeHandle' field of com.jnihelper.NativePeer; null before the first registration.
+    */
+    jfieldID nativePeerHandleField();
+
+    /**
+    * Base class of the C++ peers of java objects that extend com.jnihelper.NativePeer.
+    * Unlike JavaObjectWrapper, java creates and owns the object: its constructor asks
+    * the factory for a new peer, and 'close()' or the collection of the java object
+    * destroys it. The peer only holds a weak global reference to its java object.
+    *
+    * @param InternalJavaClass The java class of the peer. Should be declared by JH_JAVA_CUSTOM_CLASS macro.
+    * @param PeerClass The C++ class that derives from JavaNativePeer; should be default constructible
+    * and have a public 'static void linkJavaNativeMethods()' method.
+    *
+    * @warning Peers are found by the exact java class, java subclasses of the peer class should be registered separately.
+    * @warning Peers are destroyed in the java thread that closes the object or in the cleaner thread.
+    */
+    template<class InternalJavaClass, class PeerClass>
+    class JavaNativePeer
+    {
+    public:
+        /**
+        * Declaring types for later usage by internal code.
+        */
+        using JavaClass = InternalJavaClass;
+        using CppClass = PeerClass;
+
+        /**
+        * Links the native methods of the peer class and registers its factory. Only the first call
+        * does something, later calls return the same result.
+        *
+        * @param blocksPerChunk Number of peers that are allocated at once; only the first call uses it.
+        *
+        * @return True if the java objects can create their peers and call their native methods.
+        */
+        static bool registerPeerClass(std::size_t blocksPerChunk = 64)
+        {
+            static const bool registered = [blocksPerChunk] () {
+                slab(blocksPerChunk);
+
+                PeerClass::linkJavaNativeMethods();
+
+                std::vector<JNINativeMethod> descriptions;
+                for (auto& description : nativeMethodsDescriptions()) {
+                    descriptions.push_back(makeNativeMethod(description.name.c_str(), description.signature.c_str(), description.pointer));
+                }
+
+                bool result = registerNativePeerFactory(InternalJavaClass::className(), &createPeer);
+                if (result && !descriptions.empty()) {
+                    result = registerJavaNativeMethods(InternalJavaClass::className(), descriptions.size(), &descriptions[0]);
+                }
+
+                return result;
+            }();
+
+            return registered;
+        }
+
+        /**
+        * @return Usage of the slab of this peer class.
+        */
+        static PeerSlabStatistics peerStatistics()
+        {
+            return slab().statistics();
+        }
+
+        /**
+        * Returns the java object of this peer.
+        *
+        * @return Global reference; it is empty if the java object was already collected.
+        */
+        GlobalRef<InternalJavaClass> object() const
+        {
+            return m_javaObject.lock();
+        }
+
+    protected:
+        JavaNativePeer()
+        {
+            // nothing to do here
+        }
+
+        /**
+        * Registers the method of the peer class as a native java method (C++11 version).
+        * See JavaObjectWrapper::registerNativeMethod for the parameters.
+        */
+        template<int id, class ReturnType, class ... Arguments>
+        static void registerNativeMethod(std::string methodName, typename ToJavaType<ReturnType>::Type (PeerClass::*methodPointer)(typename ToJavaType<Arguments>::Type...))
+        {
+            using NativeMethodClass = JavaNativeMethod<id, PeerClass, typename ToJavaType<ReturnType>::Type, typename ToJavaType<Arguments>::Type ...>;
+
+            nativeMethodsDescriptions().push_back({
+                methodName,
+                getJavaMethodSignature<ReturnType, Arguments...>(),
+                (void*)&NativeMethodClass::rawNativeMethod
+            });
+
+            NativeMethodClass::setCallback(methodPointer);
+            NativeMethodClass::linkStats(methodName);
+        }
+
+#if __cplusplus >= 201703L
+        /**
+        * Registers the method of the peer class as a native java method.
+        * See JavaObjectWrapper::registerNativeMethod for the parameters.
+        */
+        template<auto Method, class ... JavaTypes>
+        static void registerNativeMethod(std::string methodName)
+        {
+            using NativeMethodClass = JavaNativeThunk<Method>;
+
+            nativeMethodsDescriptions().push_back({
+                methodName,
+                NativeMethodClass::template signature<JavaTypes...>(),
+                (void*)&NativeMethodClass::rawNativeMethod
+            });
+
+            NativeMethodClass::linkStats(methodName);
+        }
+#endif
+
+    private:
+        /**
+        * Native methods find the peer by the java object.
+        */
+        template<int, class, class, class ...>
+        friend class JavaNativeMethod;
+
+#if __cplusplus >= 201703L
+        template<auto>
+        friend class JavaNativeThunk;
+#endif
+
+        /**
+        * Memory of one peer; the destroy function is the first member, so the handle
+        * can be destroyed without knowing the peer class.
+        */
+        struct PeerBlock
+        {
+            NativePeerDestroyFunction destroy;
+            typename std::aligned_storage<sizeof(PeerClass), alignof(PeerClass)>::type storage;
+        };
+
+        /**
+        * Weak reference to the java object; java owns the peer, not vice versa.
+        */
+        WeakRef<InternalJavaClass> m_javaObject;
+
+        static PeerSlab& slab(std::size_t blocksPerChunk = 64)
+        {
+            static PeerSlab peerSlab(sizeof(PeerBlock), blocksPerChunk);
+            return peerSlab;
+        }
+
+        static std::vector<NativeMethodDescription>& nativeMethodsDescriptions()
+        {
+            static std::vector<NativeMethodDescription> descriptions;
+            return descriptions;
+        }
+
+        /**
+        * Factory that is called by the constructor of the java object.
+        *
+        * @return Handle of the new peer or zero if it couldn't be allocated.
+        */
+        static jlong createPeer(JNIEnv*, jobject javaObject)
+        {
+            static_assert(std::is_standard_layout<PeerBlock>::value, "peer block should start with the destroy function");
+            static_assert(alignof(PeerClass) <= alignof(std::max_align_t), "over-aligned peers are not supported by the slab");
+
+            PeerBlock* block = static_cast<PeerBlock*>(slab().allocate());
+            if (!block) {
+                return 0;
+            }
+
+            block->destroy = &destroyPeer;
+
+            PeerClass* peer = new (&block->storage) PeerClass();
+            peer->m_javaObject = WeakRef<InternalJavaClass>(javaObject);
+
+            return static_cast<jlong>(reinterpret_cast<std::intptr_t>(block));
+        }
+
+        static void destroyPeer(void* memory)
+        {
+            PeerBlock* block = static_cast<PeerBlock*>(memory);
+            reinterpret_cast<PeerClass*>(&block->storage)->~PeerClass();
+            slab().deallocate(block);
+        }
+
+        /**
+        * Finds the peer of the java object.
+        *
+        * @return The peer or nullptr (the error is already reported) if the java object was closed.
+        */
+        static PeerClass* findCppObject(JNIEnv* env, jobject javaObject)
+        {
+            jlong handle = env->GetLongField(javaObject, nativePeerHandleField());
+            if (handle) {
+                PeerBlock* block = reinterpret_cast<PeerBlock*>(static_cast<std::intptr_t>(handle));
+                return reinterpret_cast<PeerClass*>(&block->storage);
+            }
+
+            reportInternalError("couldn't call java native method - native peer of [" + InternalJavaClass::className() + "] was already closed!");
+
+            return nullptr;
+        }
+
+        /**
+        * Native peer should not be copied.
+        */
+        JavaNativePeer(const JavaNativePeer &) = delete;
+        void operator=(const JavaNativePeer &) = delete;
+    };
+}
+
+#endif
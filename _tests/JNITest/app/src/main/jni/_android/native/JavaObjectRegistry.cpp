@@ -0,0 +1,141 @@
+/**
+    \file JavaObjectRegistry.cpp
+    \brief Concurrent map from java objects to C++ objects.
+    \author Denis Sorokin
+    \date 18.03.2016
+*/
+
+#include <cstdint>
+#include <utility>
+#include "../core/ErrorHandler.hpp"
+#include "../core/JNIEnvironment.hpp"
+#include "../core/Statistics.hpp"
+#include "../native/JavaObjectRegistry.hpp"
+
+namespace jh
+{
+    namespace
+    {
+        /**
+        * Global reference to 'java.lang.System' and its 'identityHashCode' method.
+        */
+        struct IdentityHashMethod
+        {
+            jclass systemClass;
+            jmethodID method;
+        };
+
+        const IdentityHashMethod& identityHashMethod(JNIEnv* env)
+        {
+            // system classes are visible to any class loader, so any thread can do the lookup
+            static const IdentityHashMethod cached = [env]() {
+                IdentityHashMethod result = {nullptr, nullptr};
+
+                countStatistic(Statistic::ClassLookups);
+
+                jclass systemClass = env->FindClass("java/lang/System");
+                if (systemClass == nullptr) {
+                    reportInternalError("class java.lang.System not found");
+                    return result;
+                }
+
+                result.systemClass = static_cast<jclass>(env->NewGlobalRef(systemClass));
+                countStatistic(Statistic::MemberLookups);
+                result.method = env->GetStaticMethodID(systemClass, "identityHashCode", "(Ljava/lang/Object;)I");
+                env->DeleteLocalRef(systemClass);
+
+                return result;
+            }();
+
+            return cached;
+        }
+    }
+
+    jint identityHashCode(JNIEnv* env, jobject object)
+    {
+        const IdentityHashMethod& identity = identityHashMethod(env);
+
+        if (identity.method == nullptr) {
+            return 0;
+        }
+
+        return env->CallStaticIntMethod(identity.systemClass, identity.method, object);
+    }
+
+    void JavaObjectRegistry::add(jobject javaObject, void* cppObject)
+    {
+        jint hash = identityHashCode(getCurrentJNIEnvironment(), javaObject);
+
+        Shard& target = shard(hash);
+        std::lock_guard<std::mutex> lock(target.mutex);
+        target.entries.insert(std::make_pair(hash, Entry{javaObject, cppObject}));
+    }
+
+    bool JavaObjectRegistry::remove(jobject javaObject, void* cppObject)
+    {
+        if (javaObject == nullptr) {
+            return false;
+        }
+
+        JNIEnv* env = getCurrentJNIEnvironment();
+        jint hash = identityHashCode(env, javaObject);
+
+        Shard& target = shard(hash);
+        std::lock_guard<std::mutex> lock(target.mutex);
+
+        auto range = target.entries.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.cppObject == cppObject && env->IsSameObject(it->second.javaObject, javaObject)) {
+                target.entries.erase(it);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void* JavaObjectRegistry::find(JNIEnv* env, jobject javaObject) const
+    {
+        if (javaObject == nullptr) {
+            return nullptr;
+        }
+
+        jint hash = identityHashCode(env, javaObject);
+
+        const Shard& target = shard(hash);
+        std::lock_guard<std::mutex> lock(target.mutex);
+
+        auto range = target.entries.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (env->IsSameObject(it->second.javaObject, javaObject)) {
+                return it->second.cppObject;
+            }
+        }
+
+        return nullptr;
+    }
+
+    std::size_t JavaObjectRegistry::size() const
+    {
+        std::size_t result = 0;
+
+        for (const Shard& each : m_shards) {
+            std::lock_guard<std::mutex> lock(each.mutex);
+            result += each.entries.size();
+        }
+
+        return result;
+    }
+
+    const JavaObjectRegistry::Shard& JavaObjectRegistry::shard(jint hash) const
+    {
+        // identity hashes may be sequential, so the bits are mixed before picking the shard
+        std::uint32_t mixed = static_cast<std::uint32_t>(hash) * 0x9E3779B1u;
+        return m_shards[(mixed >> 24) % kShardCount];
+    }
+
+    JavaObjectRegistry::Shard& JavaObjectRegistry::shard(jint hash)
+    {
+        return const_cast<Shard&>(static_cast<const JavaObjectRegistry*>(this)->shard(hash));
+    }
+}
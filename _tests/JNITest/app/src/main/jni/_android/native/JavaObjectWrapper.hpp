@@ -16,6 +16,9 @@
 * public class Example
 * {
 *     ...
+*     // Optional: pointer to the C++ wrapper, makes native calls O(1) (see 'usePeerField'):
+*     private long nativeHandle;
+*
 *     protected native void someVoidMethod();
 *     protected native int sumTwo(int x, int y);
 *     ...
@@ -34,11 +37,20 @@
 *     // We need to implement two abstract methods - 'linkJavaNativeMethods' and 'initializeJavaObject'.
 *
 *     // Inside 'linkJavaNativeMethods' method we should register all native methods of the wrapped class.
-*     // First argument should be unique method ID for this wrapper class:
+*     // The method itself is the template argument and the signature is deduced (C++17):
 *     void linkJavaNativeMethods() override
 *     {
-*         registerNativeMethod<1, void>("someVoidMethod", &ExampleWrapper::interstitialPressed);
-*         registerNativeMethod<2, int, int, int>("sumTwo", &ExampleWrapper::interstitialClosed);
+*         registerNativeMethod<&ExampleWrapper::someVoidMethod>("someVoidMethod");
+*         registerNativeMethod<&ExampleWrapper::sumTwo>("sumTwo");
+*
+*         // Java types should be listed for custom classes and object arrays:
+*         //     registerNativeMethod<&ExampleWrapper::join, jstring, jh::JavaArray<jstring>>("join");
+*
+*         // C++11 version; first argument should be unique method ID for this wrapper class:
+*         //     registerNativeMethod<1, int, int, int>("sumTwo", &ExampleWrapper::sumTwo);
+*
+*         // Native calls find the wrapper through the java field instead of searching all wrappers:
+*         usePeerField("nativeHandle");
 *     }
 *
 *     // Inside 'initializeJavaObject' method we should created and return an instance of wrapped java class.
@@ -70,31 +82,24 @@
 #ifndef JH_JAVA_OBJECT_WRAPPER_HPP
 #define JH_JAVA_OBJECT_WRAPPER_HPP
 
-#include <set>
+#include <atomic>
+#include <mutex>
+#include <string>
 #include <vector>
-#include <functional>
+#include <cstdint>
+#include <utility>
 #include <jni.h>
 #include "../core/ToJavaType.hpp"
 #include "../core/ErrorHandler.hpp"
+#include "../core/Statistics.hpp"
+#include "../core/JNIEnvironment.hpp"
 #include "../native/JavaNativeMethod.hpp"
+#include "../native/JavaObjectRegistry.hpp"
 #include "../utils/JavaObjectPointer.hpp"
+#include "../utils/JavaReferences.hpp"
 
 namespace jh
 {
-    /**
-    * Small utility structure to hold information about java native methods.
-    *
-    * @param name Name of the java native method.
-    * @param signature Full signature of the java native method.
-    * @param pointer A pointer to the C++ function that should be called as native method.
-    */
-    struct NativeMethodDescription
-    {
-        std::string name;
-        std::string signature;
-        void* pointer;
-    };
-
     /**
     * Class that wraps some java class by the C++ class.
     * It was designed that the java class instances should be created only by this wrapper class.
@@ -113,37 +118,54 @@ namespace jh
         using CppClass = WrapperClass;
 
     private:
-        /**
-        * Information about exsiting links between java objects and cpp wrappers.
-        */
-        using WrapperObjectInfo = std::pair<jobject, CppClass*>;
-
         /**
         * Native methods should have full access to the wrapper class.
         */
         template<int, class, class, class ...>
         friend class JavaNativeMethod;
 
+#if __cplusplus >= 201703L
+        template<auto>
+        friend class JavaNativeThunk;
+#endif
+
         /**
-        * Pool of all wrapper objects and their jobjects.
+        * Pool of all wrapper objects and their jobjects; native methods can be called from any thread.
         */
-        static std::set<WrapperObjectInfo> s_objectsCollection;
+        static JavaObjectRegistry s_objectsCollection;
 
         /**
-        * Finds the wrapper object for jobject instance and calls the required method.
+        * Name and ID of the java 'long' field that holds the pointer to the wrapper object.
+        * The ID is null if the wrapper objects are searched in the pool instead.
         */
-        template<class MethodReturnType>
-        static MethodReturnType callCppObjectMethod(jobject javaObject, std::function<MethodReturnType(CppClass*)> callback)
+        static std::string s_peerFieldName;
+        static jfieldID s_peerField;
+
+        /**
+        * Finds the wrapper object for jobject instance.
+        *
+        * @return The wrapper object or nullptr (the error is already reported) if there is none.
+        */
+        static CppClass* findCppObject(JNIEnv* env, jobject javaObject)
         {
-            for (auto& entry: s_objectsCollection) {
-                if (jh::areEqual(entry.first, javaObject)) {
-                    return callback(entry.second);
+            if (s_peerField) {
+                jlong handle = env->GetLongField(javaObject, s_peerField);
+                if (handle) {
+                    return reinterpret_cast<CppClass*>(static_cast<std::intptr_t>(handle));
                 }
+
+                reportInternalError("couldn't call java native method - cpp object was already destroyed!");
+
+                return nullptr;
+            }
+
+            if (void* cppObject = s_objectsCollection.find(env, javaObject)) {
+                return static_cast<CppClass*>(cppObject);
             }
 
             reportInternalError("couldn't call java native method - cpp object not found!");
 
-            return MethodReturnType();
+            return nullptr;
         }
 
         /**
@@ -151,7 +173,13 @@ namespace jh
         */
         void registerObject(jobject javaObject, CppClass* cppObject)
         {
-            s_objectsCollection.insert(WrapperObjectInfo(javaObject, cppObject));
+            if (s_peerField) {
+                jlong handle = static_cast<jlong>(reinterpret_cast<std::intptr_t>(cppObject));
+                getCurrentJNIEnvironment()->SetLongField(javaObject, s_peerField, handle);
+                return;
+            }
+
+            s_objectsCollection.add(javaObject, cppObject);
         }
 
         /**
@@ -159,15 +187,47 @@ namespace jh
         */
         void unregisterObject(jobject javaObject, CppClass* cppObject)
         {
-            auto entry = s_objectsCollection.find(WrapperObjectInfo(javaObject, cppObject));
+            if (s_peerField) {
+                // late native calls from java will report an error instead of using the dead wrapper
+                if (javaObject) {
+                    getCurrentJNIEnvironment()->SetLongField(javaObject, s_peerField, 0);
+                }
+                return;
+            }
 
-            if (entry != s_objectsCollection.end()) {
-                s_objectsCollection.erase(entry);
-            } else {
+            if (!s_objectsCollection.remove(javaObject, cppObject)) {
                 reportInternalError("unable to unregister cpp interstitial - not found");
             }
         }
 
+        /**
+        * Looks up the peer field ID if the peer field is used; called once with the native methods registration.
+        */
+        static void resolvePeerField()
+        {
+            if (s_peerFieldName.empty()) {
+                return;
+            }
+
+            JNIEnv* env = getCurrentJNIEnvironment();
+
+            countStatistic(Statistic::ClassLookups);
+
+            LocalRef<jclass> javaClass(env->FindClass(InternalJavaClass::className().c_str()));
+            if (!javaClass) {
+                env->ExceptionClear();
+                reportInternalError("java class [" + InternalJavaClass::className() + "] not found, wrapper objects will be searched instead");
+                return;
+            }
+
+            countStatistic(Statistic::MemberLookups);
+            s_peerField = env->GetFieldID(javaClass, s_peerFieldName.c_str(), "J");
+            if (!s_peerField) {
+                env->ExceptionClear();
+                reportInternalError("long field [" + s_peerFieldName + "] not found in java class [" + InternalJavaClass::className() + "], wrapper objects will be searched instead");
+            }
+        }
+
     public:
         /**
         * Default constructor for java wrapper object.
@@ -192,30 +252,12 @@ namespace jh
         */
         jobject object()
         {
-            if (!s_nativeMethodsWereRegistered) {
-                linkJavaNativeMethods();
-
-                std::vector<JNINativeMethod> descriptions;
-                for (auto& description : s_nativeMethodsDescriptions) {
-                    descriptions.push_back({
-                        description.name.c_str(),
-                        description.signature.c_str(),
-                        description.pointer
-                    });
-                }
-
-                if (s_nativeMethodsDescriptions.size() > 0) {
-                    s_nativeMethodsWereRegistered = registerJavaNativeMethods(
-                            InternalJavaClass::className(),
-                            descriptions.size(),
-                            &descriptions[0]
-                    );
-                } else {
-                    s_nativeMethodsWereRegistered = true;
-                }
-            }
-
             if (!m_javaObject) {
+                // java can't call native methods before the first object exists, so they are registered here
+                std::call_once(s_nativeMethodsRegistration, [this] () {
+                    registerNativeMethods();
+                });
+
                 m_javaObject = initializeJavaObject();
 
                 if (m_javaObject) {
@@ -226,6 +268,16 @@ namespace jh
             return m_javaObject;
         }
 
+        /**
+        * Checks if the native methods were registered; the registration is not retried after a failure.
+        *
+        * @return True after the successful registration and false before the first java object is created or if it failed.
+        */
+        static bool nativeMethodsWereRegistered()
+        {
+            return s_nativeMethodsWereRegistered;
+        }
+
     private:
         /**
         * Pointer to the wrapped java object.
@@ -238,11 +290,38 @@ namespace jh
         virtual jobject initializeJavaObject() = 0;
 
         /**
-        * Holds the information about native methods registration.
+        * Holds the information about native methods registration. Registration is done only once,
+        * even if it fails or wrapper objects are created by several threads at the same time.
         */
-        static bool s_nativeMethodsWereRegistered;
+        static std::once_flag s_nativeMethodsRegistration;
+        static std::atomic<bool> s_nativeMethodsWereRegistered;
         static std::vector<NativeMethodDescription> s_nativeMethodsDescriptions;
 
+        /**
+        * Links and registers the native methods and looks up the peer field.
+        */
+        void registerNativeMethods()
+        {
+            linkJavaNativeMethods();
+
+            std::vector<JNINativeMethod> descriptions;
+            for (auto& description : s_nativeMethodsDescriptions) {
+                descriptions.push_back(makeNativeMethod(description.name.c_str(), description.signature.c_str(), description.pointer));
+            }
+
+            if (s_nativeMethodsDescriptions.size() > 0) {
+                s_nativeMethodsWereRegistered = registerJavaNativeMethods(
+                        InternalJavaClass::className(),
+                        descriptions.size(),
+                        &descriptions[0]
+                );
+            } else {
+                s_nativeMethodsWereRegistered = true;
+            }
+
+            resolvePeerField();
+        }
+
         /**
         * This method should specify all necessary native methods that will be used by the java class.
         */
@@ -250,7 +329,7 @@ namespace jh
 
     protected:
         /**
-        * Registers the local method as a native java method
+        * Registers the local method as a native java method (C++11 version, see also the version without id).
         *
         * @param id Dirty hack to distinguish two native methods with equal signatures. Should be unique for every native method per wrapper class.
         * @param ReturnType The return type of java native method.
@@ -271,17 +350,66 @@ namespace jh
             });
 
             NativeMethodClass::setCallback(methodPointer);
+            NativeMethodClass::linkStats(methodName);
+        }
+
+#if __cplusplus >= 201703L
+        /**
+        * Registers the local method as a native java method. The method is a template argument,
+        * so the generated native function calls it directly and can be completely inlined.
+        *
+        * @param Method Pointer to the method of the wrapper class, like '&ExampleWrapper::someMethod'.
+        * @param JavaTypes The return type and the argument types of java native method; only needed when
+        * the deduced JNI types don't describe java types precisely, like custom classes or object arrays.
+        *
+        * @warning Native methods that were registered this way should NOT be called inside the java object constructor.
+        */
+        template<auto Method, class ... JavaTypes>
+        void registerNativeMethod(std::string methodName)
+        {
+            using NativeMethodClass = JavaNativeThunk<Method>;
+
+            s_nativeMethodsDescriptions.push_back({
+                methodName,
+                NativeMethodClass::template signature<JavaTypes...>(),
+                (void*)&NativeMethodClass::rawNativeMethod
+            });
+
+            NativeMethodClass::linkStats(methodName);
+        }
+#endif
+
+        /**
+        * Stores the pointer to the wrapper object in the java 'long' field, so native methods
+        * find their wrapper object in constant time instead of comparing the java object with
+        * every existing wrapper. Should be called inside 'linkJavaNativeMethods'.
+        *
+        * @param fieldName Name of the 'long' field of the wrapped java class. The field should
+        * not be used by java code itself.
+        */
+        void usePeerField(std::string fieldName)
+        {
+            s_peerFieldName = std::move(fieldName);
         }
     };
 
     template <class InternalJavaClass, class WrapperClass>
-    std::set<typename JavaObjectWrapper<InternalJavaClass, WrapperClass>::WrapperObjectInfo> JavaObjectWrapper<InternalJavaClass, WrapperClass>::s_objectsCollection;
+    JavaObjectRegistry JavaObjectWrapper<InternalJavaClass, WrapperClass>::s_objectsCollection;
+
+    template <class InternalJavaClass, class WrapperClass>
+    std::string JavaObjectWrapper<InternalJavaClass, WrapperClass>::s_peerFieldName;
+
+    template <class InternalJavaClass, class WrapperClass>
+    jfieldID JavaObjectWrapper<InternalJavaClass, WrapperClass>::s_peerField = nullptr;
 
     template <class InternalJavaClass, class WrapperClass>
     std::vector<NativeMethodDescription> JavaObjectWrapper<InternalJavaClass, WrapperClass>::s_nativeMethodsDescriptions;
 
     template <class InternalJavaClass, class WrapperClass>
-    bool JavaObjectWrapper<InternalJavaClass, WrapperClass>::s_nativeMethodsWereRegistered = false;
+    std::once_flag JavaObjectWrapper<InternalJavaClass, WrapperClass>::s_nativeMethodsRegistration;
+
+    template <class InternalJavaClass, class WrapperClass>
+    std::atomic<bool> JavaObjectWrapper<InternalJavaClass, WrapperClass>::s_nativeMethodsWereRegistered(false);
 }
 
 #endif
@@ -0,0 +1,404 @@
+/**
+    \file NativeArgument.hpp
+    \brief Conversion of arguments and results of the native methods of the wrapper classes.
+    \author Denis Sorokin
+    \date 20.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* class ExampleWrapper : public jh::JavaObjectWrapper<JavaExample, ExampleWrapper>
+* {
+*     void linkJavaNativeMethods() override
+*     {
+*         // Signatures are deduced from the C++ types: "(Ljava/lang/String;[I[F)Ljava/lang/String;"
+*         registerNativeMethod<&ExampleWrapper::describe>("describe");
+*     }
+*
+*     // Java string is borrowed and int array is pinned until the method returns,
+*     // float array is copied with one region copy; the result becomes a java string:
+*     std::string describe(std::string_view name, jh::Span<const jint> ids, const std::vector<jfloat>& weights)
+*     {
+*         ...
+*     }
+*
+*     // Elements of the non-const span are written back to the java array:
+*     void normalize(jh::Span<jfloat> values) { ... }
+* }
+*
+* @endcode
+*/
+
+#ifndef JH_NATIVE_ARGUMENT_HPP
+#define JH_NATIVE_ARGUMENT_HPP
+
+#if __cplusplus >= 201703L
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <jni.h>
+#include "../arrays/ArrayAllocator.hpp"
+#include "../arrays/ArrayGetter.hpp"
+#include "../arrays/ArrayPinner.hpp"
+#include "../arrays/ArraySetter.hpp"
+#include "../arrays/StringArrays.hpp"
+#include "../utils/JStringUtils.hpp"
+#include "../utils/JStringView.hpp"
+
+namespace jh
+{
+    /**
+    * View of the contiguous elements; used for pinned java primitive arrays.
+    *
+    * @param ElementType Type of the elements; const for read-only views.
+    */
+    template<class ElementType>
+    class Span
+    {
+    public:
+        Span()
+        : m_data(nullptr)
+        , m_size(0)
+        {
+            // nothing to do here
+        }
+
+        Span(ElementType* data, std::size_t size)
+        : m_data(data)
+        , m_size(size)
+        {
+            // nothing to do here
+        }
+
+        ElementType* data() const { return m_data; }
+        std::size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+        ElementType* begin() const { return m_data; }
+        ElementType* end() const { return m_data + m_size; }
+
+        ElementType& operator[](std::size_t index) const { return m_data[index]; }
+
+    private:
+        ElementType* m_data;
+        std::size_t m_size;
+    };
+
+    /**
+    * Java primitive array type for the JNI element type.
+    */
+    template<class ElementType>
+    struct JavaArrayOf;
+
+    template<> struct JavaArrayOf<jboolean> { using Type = jbooleanArray; };
+    template<> struct JavaArrayOf<jbyte> { using Type = jbyteArray; };
+    template<> struct JavaArrayOf<jchar> { using Type = jcharArray; };
+    template<> struct JavaArrayOf<jshort> { using Type = jshortArray; };
+    template<> struct JavaArrayOf<jint> { using Type = jintArray; };
+    template<> struct JavaArrayOf<jlong> { using Type = jlongArray; };
+    template<> struct JavaArrayOf<jfloat> { using Type = jfloatArray; };
+    template<> struct JavaArrayOf<jdouble> { using Type = jdoubleArray; };
+
+    /**
+    * Converts the argument of java native method to the C++ parameter type. The object lives
+    * until the C++ method returns, so it can own borrowed or pinned java data.
+    *
+    * JavaType - JNI type that java passes to the native method.
+    * SignatureType - type that describes the argument in the method signature (see ToJavaType).
+    * get() - the value that is passed to the C++ method.
+    *
+    * Default implementation passes JNI types as they are.
+    */
+    template<class CppType>
+    struct NativeArgument
+    {
+        using JavaType = CppType;
+        using SignatureType = CppType;
+
+        NativeArgument(JNIEnv*, JavaType value)
+        : m_value(value)
+        {
+            // nothing to do here
+        }
+
+        CppType get() const
+        {
+            return m_value;
+        }
+
+    private:
+        JavaType m_value;
+    };
+
+    /**
+    * Java string as a UTF-8 view. Characters are borrowed from the VM, and only copied
+    * when the modified UTF-8 of java differs from the standard one (zero or supplementary characters).
+    */
+    template<>
+    struct NativeArgument<std::string_view>
+    {
+        using JavaType = jstring;
+        using SignatureType = jstring;
+
+        NativeArgument(JNIEnv*, jstring value)
+        : m_view(value, JStringAccess::ModifiedUtf8)
+        {
+            const char* utf8 = m_view.modifiedUtf8();
+            std::size_t size = m_view.modifiedUtf8Size();
+
+            if (utf8 == nullptr) {
+                return;
+            }
+
+            if (isStandardUtf8(utf8, size)) {
+                m_text = std::string_view(utf8, size);
+            } else {
+                jstringToBuffer(value, m_copy);
+                m_text = m_copy;
+            }
+        }
+
+        std::string_view get() const
+        {
+            return m_text;
+        }
+
+    private:
+        JStringView m_view;
+        std::string m_copy;
+        std::string_view m_text;
+
+        /**
+        * Modified UTF-8 encodes zero as 'C0 80' and surrogates with the 'ED A0..BF' prefix.
+        */
+        static bool isStandardUtf8(const char* utf8, std::size_t size)
+        {
+            for (std::size_t i = 0; i + 1 < size; ++i) {
+                unsigned char byte = static_cast<unsigned char>(utf8[i]);
+                unsigned char next = static_cast<unsigned char>(utf8[i + 1]);
+
+                if ((byte == 0xC0 && next == 0x80) || (byte == 0xED && next >= 0xA0)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    };
+
+    /**
+    * Java string as a copy in std::string.
+    */
+    template<>
+    struct NativeArgument<std::string>
+    {
+        using JavaType = jstring;
+        using SignatureType = jstring;
+
+        NativeArgument(JNIEnv*, jstring value)
+        : m_text(value ? jstringToStdString(value) : std::string())
+        {
+            // nothing to do here
+        }
+
+        const std::string& get() const
+        {
+            return m_text;
+        }
+
+    private:
+        std::string m_text;
+    };
+
+    /**
+    * Java primitive array as a pinned span. Changes of the non-const span are written back.
+    */
+    template<class ElementType>
+    struct NativeArgument<Span<ElementType>>
+    {
+        using JavaElementType = typename std::remove_const<ElementType>::type;
+        using JavaType = typename JavaArrayOf<JavaElementType>::Type;
+        using SignatureType = JavaType;
+        using Pinner = JavaArrayPinner<JavaType>;
+
+        NativeArgument(JNIEnv* env, JavaType value)
+        : m_env(env)
+        , m_array(value)
+        , m_elements(nullptr)
+        , m_size(0)
+        {
+            if (value) {
+                m_size = static_cast<std::size_t>(env->GetArrayLength(value));
+                m_elements = Pinner::pin(env, value, ArrayPinMode::Elements);
+            }
+        }
+
+        ~NativeArgument()
+        {
+            if (m_elements) {
+                jint releaseMode = std::is_const<ElementType>::value ? JNI_ABORT : 0;
+                Pinner::release(m_env, m_array, m_elements, ArrayPinMode::Elements, releaseMode);
+            }
+        }
+
+        Span<ElementType> get() const
+        {
+            return m_elements ? Span<ElementType>(m_elements, m_size) : Span<ElementType>();
+        }
+
+    private:
+        JNIEnv* m_env;
+        JavaType m_array;
+        JavaElementType* m_elements;
+        std::size_t m_size;
+
+        NativeArgument(const NativeArgument &) = delete;
+        void operator=(const NativeArgument &) = delete;
+    };
+
+    /**
+    * Java primitive array as a copy in std::vector (one region copy).
+    */
+    template<class ElementType>
+    struct NativeArgument<std::vector<ElementType>>
+    {
+        using JavaType = typename JavaArrayOf<ElementType>::Type;
+        using SignatureType = JavaType;
+
+        NativeArgument(JNIEnv* env, JavaType value)
+        : m_elements(value ? JavaArrayGetter<JavaType>::get(env, value) : std::vector<ElementType>())
+        {
+            // nothing to do here
+        }
+
+        const std::vector<ElementType>& get() const
+        {
+            return m_elements;
+        }
+
+    private:
+        std::vector<ElementType> m_elements;
+    };
+
+    /**
+    * Java string array as a copy in std::vector.
+    */
+    template<>
+    struct NativeArgument<std::vector<std::string>>
+    {
+        using JavaType = jobjectArray;
+        using SignatureType = JavaArray<jstring>;
+
+        NativeArgument(JNIEnv*, jobjectArray value)
+        : m_strings(value ? fromJavaStringArray(value) : std::vector<std::string>())
+        {
+            // nothing to do here
+        }
+
+        const std::vector<std::string>& get() const
+        {
+            return m_strings;
+        }
+
+    private:
+        std::vector<std::string> m_strings;
+    };
+
+    /**
+    * Converts the result of the C++ method to the result of java native method.
+    *
+    * JavaType - JNI type that is returned to java.
+    * SignatureType - type that describes the result in the method signature (see ToJavaType).
+    * toJava() - the conversion itself.
+    *
+    * Default implementation returns JNI types as they are.
+    */
+    template<class CppType>
+    struct NativeResult
+    {
+        using JavaType = CppType;
+        using SignatureType = CppType;
+
+        static JavaType toJava(JNIEnv*, CppType value)
+        {
+            return value;
+        }
+    };
+
+    /**
+    * Methods without results.
+    */
+    template<>
+    struct NativeResult<void>
+    {
+        using JavaType = void;
+        using SignatureType = void;
+    };
+
+    /**
+    * std::string is returned as a new java string.
+    */
+    template<>
+    struct NativeResult<std::string>
+    {
+        using JavaType = jstring;
+        using SignatureType = jstring;
+
+        static jstring toJava(JNIEnv*, const std::string& value)
+        {
+            return createJString(value);
+        }
+    };
+
+    /**
+    * std::vector of primitive values is returned as a new java array filled with one region copy.
+    */
+    template<class ElementType>
+    struct NativeResult<std::vector<ElementType>>
+    {
+        using JavaType = typename JavaArrayOf<ElementType>::Type;
+        using SignatureType = JavaType;
+
+        static JavaType toJava(JNIEnv* env, const std::vector<ElementType>& value)
+        {
+            JavaType array = JavaArrayAllocator<JavaType, ElementType>::create(env, static_cast<jsize>(value.size()));
+
+            if (array && !value.empty()) {
+                JavaArraySetter<JavaType>::set(env, array, static_cast<jsize>(value.size()), const_cast<ElementType*>(value.data()));
+            }
+
+            return array;
+        }
+    };
+
+    /**
+    * std::vector of strings is returned as a new java string array.
+    */
+    template<>
+    struct NativeResult<std::vector<std::string>>
+    {
+        using JavaType = jobjectArray;
+        using SignatureType = JavaArray<jstring>;
+
+        static jobjectArray toJava(JNIEnv*, const std::vector<std::string>& value)
+        {
+            return toJavaStringArray(value);
+        }
+    };
+
+    /**
+    * Conversion types of the C++ parameter (references and constness are ignored, except for spans).
+    */
+    template<class CppType>
+    using NativeArgumentFor = NativeArgument<typename std::decay<CppType>::type>;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,127 @@
+/**
+    \file NativeMethodStats.cpp
+    \brief Optional call counters and latency histograms of java native methods.
+    \author Denis Sorokin
+    \date 22.03.2016
+*/
+
+#include <mutex>
+#include <sstream>
+#include <jni.h>
+#include "../core/ErrorHandler.hpp"
+#include "../native/JavaNativeMethod.hpp"
+#include "../native/NativeMethodStats.hpp"
+#include "../utils/JStringUtils.hpp"
+
+namespace jh
+{
+#ifdef JH_NATIVE_METHOD_STATS
+    namespace
+    {
+        struct NativeMethodName
+        {
+            std::string className;
+            std::string methodName;
+        };
+
+        /**
+        * Names of the slots; slot 'i' is described by 'slotNames[i - 1]'.
+        */
+        std::mutex& slotNamesMutex()
+        {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::vector<NativeMethodName>& slotNames()
+        {
+            static std::vector<NativeMethodName> names;
+            return names;
+        }
+    }
+
+    std::size_t registerNativeMethodStatsSlot(const std::string& className, const std::string& methodName)
+    {
+        std::lock_guard<std::mutex> lock(slotNamesMutex());
+
+        auto& names = slotNames();
+        if (names.size() + 1 >= kMaxNativeMethodStats) {
+            reportInternalError("too many native methods, [" + className + "." + methodName + "] is not counted");
+            return 0;
+        }
+
+        names.push_back({className, methodName});
+
+        return names.size();
+    }
+
+    std::vector<NativeMethodStatistics> nativeMethodStats()
+    {
+        std::vector<NativeMethodName> names;
+        {
+            std::lock_guard<std::mutex> lock(slotNamesMutex());
+            names = slotNames();
+        }
+
+        std::vector<NativeMethodStatistics> statistics;
+        statistics.reserve(names.size());
+
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            statistics.push_back({names[i].className, names[i].methodName, NativeMethodLatencyStats::collect(i + 1)});
+        }
+
+        return statistics;
+    }
+#else
+    std::size_t registerNativeMethodStatsSlot(const std::string&, const std::string&)
+    {
+        return 0;
+    }
+
+    std::vector<NativeMethodStatistics> nativeMethodStats()
+    {
+        return std::vector<NativeMethodStatistics>();
+    }
+#endif
+
+    std::string formatNativeMethodStats()
+    {
+        std::vector<NativeMethodStatistics> statistics = nativeMethodStats();
+
+        if (statistics.empty()) {
+            return "no native method statistics (is JH_NATIVE_METHOD_STATS defined?)\n";
+        }
+
+        std::ostringstream text;
+        for (const NativeMethodStatistics& method : statistics) {
+            const LatencySummary& latency = method.latency;
+
+            text << method.className << "." << method.methodName
+                 << ": calls=" << latency.calls
+                 << " total=" << latency.totalNanoseconds / 1000 << "us"
+                 << " p50=" << latency.p50Nanoseconds << "ns"
+                 << " p90=" << latency.p90Nanoseconds << "ns"
+                 << " p99=" << latency.p99Nanoseconds << "ns"
+                 << " max=" << latency.maxNanoseconds << "ns\n";
+        }
+
+        return text.str();
+    }
+
+    namespace
+    {
+        jstring dumpNativeMethodStats(JNIEnv*, jclass)
+        {
+            return createJString(formatNativeMethodStats());
+        }
+    }
+
+    bool registerNativeMethodStatsDump()
+    {
+        JNINativeMethod method[1] = {
+            makeNativeMethod("dump", "()Ljava/lang/String;", (void*)&dumpNativeMethodStats)
+        };
+
+        return registerJavaNativeMethods("com/jnihelper/NativeMethodStats", 1, method);
+    }
+}
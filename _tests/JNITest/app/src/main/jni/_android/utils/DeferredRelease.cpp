@@ -0,0 +1,139 @@
+/**
+    \file DeferredRelease.cpp
+    \brief Deletion of global references from threads without JNI environment.
+    \author Denis Sorokin
+    \date 17.03.2016
+*/
+
+#include <atomic>
+#include <cstdint>
+#include "../core/JNIEnvironment.hpp"
+#include "../core/Statistics.hpp"
+#include "../utils/DeferredRelease.hpp"
+
+namespace jh
+{
+    namespace
+    {
+        struct DeferredReference
+        {
+            jobject reference;
+            bool weak;
+            DeferredReference* next;
+        };
+
+        /**
+        * Lock-free stack of queued references; it is always drained as a whole,
+        * so there is no ABA problem.
+        */
+        std::atomic<DeferredReference*> deferredReferences(nullptr);
+        std::atomic<std::size_t> pendingCount(0);
+
+        std::atomic<std::size_t> flushThreshold(64);
+        std::atomic<std::int64_t> flushIntervalNanoseconds(std::chrono::nanoseconds(std::chrono::milliseconds(100)).count());
+        std::atomic<std::int64_t> lastFlushNanoseconds(0);
+
+        std::int64_t nowNanoseconds()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        void deleteReference(JNIEnv* env, jobject reference, bool weak)
+        {
+            if (weak) {
+                env->DeleteWeakGlobalRef(reference);
+            } else {
+                env->DeleteGlobalRef(reference);
+            }
+        }
+
+        std::size_t flush(JNIEnv* env)
+        {
+            DeferredReference* node = deferredReferences.exchange(nullptr, std::memory_order_acquire);
+            lastFlushNanoseconds.store(nowNanoseconds(), std::memory_order_relaxed);
+
+            std::size_t count = 0;
+            while (node) {
+                DeferredReference* next = node->next;
+                deleteReference(env, node->reference, node->weak);
+                delete node;
+                node = next;
+                ++count;
+            }
+
+            pendingCount.fetch_sub(count, std::memory_order_relaxed);
+            return count;
+        }
+
+        void release(jobject reference, bool weak)
+        {
+            if (reference == nullptr) {
+                return;
+            }
+
+            // the owner has given the reference up, even if it is deleted later
+            countStatistic(weak ? Statistic::LiveWeakReferences : Statistic::LiveGlobalReferences, -1);
+
+            JNIEnv* env = tryGetCurrentJNIEnvironment();
+
+            if (env == nullptr) {
+                // counted first, so a concurrent flush never makes the counter negative
+                pendingCount.fetch_add(1, std::memory_order_relaxed);
+
+                DeferredReference* node = new DeferredReference{reference, weak, nullptr};
+                node->next = deferredReferences.load(std::memory_order_relaxed);
+                while (!deferredReferences.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+                    // node->next is updated by the failed exchange
+                }
+
+                return;
+            }
+
+            deleteReference(env, reference, weak);
+
+            // the common case: nothing is queued, so the clock is not even checked
+            std::size_t pending = pendingCount.load(std::memory_order_relaxed);
+            if (pending == 0) {
+                return;
+            }
+
+            bool thresholdReached = pending >= flushThreshold.load(std::memory_order_relaxed);
+            bool intervalPassed = nowNanoseconds() - lastFlushNanoseconds.load(std::memory_order_relaxed) >= flushIntervalNanoseconds.load(std::memory_order_relaxed);
+
+            if (thresholdReached || intervalPassed) {
+                flush(env);
+            }
+        }
+    }
+
+    void releaseGlobalReference(jobject globalReference)
+    {
+        release(globalReference, false);
+    }
+
+    void releaseWeakReference(jweak weakReference)
+    {
+        release(weakReference, true);
+    }
+
+    std::size_t flushDeferredReleases()
+    {
+        JNIEnv* env = tryGetCurrentJNIEnvironment();
+        if (env == nullptr) {
+            return 0;
+        }
+
+        return flush(env);
+    }
+
+    void configureDeferredReleases(std::size_t threshold, std::chrono::milliseconds interval)
+    {
+        flushThreshold.store(threshold, std::memory_order_relaxed);
+        flushIntervalNanoseconds.store(std::chrono::nanoseconds(interval).count(), std::memory_order_relaxed);
+    }
+
+    std::size_t pendingDeferredReleases()
+    {
+        return pendingCount.load(std::memory_order_relaxed);
+    }
+}
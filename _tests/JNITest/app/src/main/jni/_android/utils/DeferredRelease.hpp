@@ -0,0 +1,73 @@
+/**
+    \file DeferredRelease.hpp
+    \brief Deletion of global references from threads without JNI environment.
+    \author Denis Sorokin
+    \date 17.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // Native worker thread (not attached to the JVM) drops the last owner; the global
+* // reference is queued instead of crashing on the missing JNIEnv:
+* std::thread([shared] { ... }).detach();
+*
+* // Queued references are deleted by attached threads after 64 queued references
+* // or 100 ms after the previous flush (whichever comes first):
+* jh::configureDeferredReleases(64, std::chrono::milliseconds(100));
+*
+* // Or explicitly (for example, once per frame in the java thread):
+* jh::flushDeferredReleases();
+*
+* @endcode
+*/
+
+#ifndef JH_DEFERRED_RELEASE_HPP
+#define JH_DEFERRED_RELEASE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <jni.h>
+
+namespace jh
+{
+    /**
+    * Deletes the global reference right away if the current thread is attached to the JVM,
+    * or queues it otherwise. Attached threads also flush the queue when it is due.
+    * Used by all library classes that own global references.
+    *
+    * @param globalReference Global reference to delete; nullptr is ignored.
+    */
+    void releaseGlobalReference(jobject globalReference);
+
+    /**
+    * Same as 'releaseGlobalReference', but for weak global references.
+    *
+    * @param weakReference Weak global reference to delete; nullptr is ignored.
+    */
+    void releaseWeakReference(jweak weakReference);
+
+    /**
+    * Deletes all queued references; does nothing in threads without JNI environment.
+    *
+    * @return Number of deleted references.
+    */
+    std::size_t flushDeferredReleases();
+
+    /**
+    * Changes when attached threads flush the queue on their own.
+    *
+    * @param threshold Queue is flushed when it has this many references.
+    * @param interval Queue is flushed when this much time has passed since the previous flush.
+    */
+    void configureDeferredReleases(std::size_t threshold, std::chrono::milliseconds interval);
+
+    /**
+    * Number of references waiting in the queue.
+    */
+    std::size_t pendingDeferredReleases();
+}
+
+#endif
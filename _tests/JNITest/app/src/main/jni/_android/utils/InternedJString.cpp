@@ -0,0 +1,277 @@
+/**
+    \file InternedJString.cpp
+    \brief Cache of java strings for constant and frequently repeated text.
+    \author Denis Sorokin
+    \date 13.03.2016
+*/
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../core/ErrorHandler.hpp"
+#include "../core/JNIEnvironment.hpp"
+#include "../calls/InstanceCaller.hpp"
+#include "../utils/JStringUtils.hpp"
+#include "../utils/InternedJString.hpp"
+
+namespace jh
+{
+    namespace
+    {
+        const std::size_t kDefaultCapacity = 256;
+
+        /**
+        * Bounded LRU cache of global references to java strings.
+        */
+        class InternedStringCache
+        {
+        public:
+            InternedStringCache()
+            : m_capacity(kDefaultCapacity)
+            , m_useJavaIntern(false)
+            , m_hits(0)
+            , m_misses(0)
+            , m_evictions(0)
+            {
+                // nothing to do here
+            }
+
+            jstring lookup(const std::string& str)
+            {
+                JNIEnv* env = getCurrentJNIEnvironment();
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+
+                    auto it = m_index.find(str);
+                    if (it != m_index.end()) {
+                        ++m_hits;
+                        m_entries.splice(m_entries.begin(), m_entries, it->second);
+                        return static_cast<jstring>(env->NewLocalRef(it->second->second));
+                    }
+
+                    ++m_misses;
+                }
+
+                // java string is created outside of the lock
+                jstring created = createString(str);
+                if (created == nullptr) {
+                    return nullptr;
+                }
+
+                jobject global = env->NewGlobalRef(created);
+                if (global == nullptr) {
+                    // the string is still usable, it just isn't cached
+                    reportInternalError("unable to cache interned java string");
+                    return created;
+                }
+
+                std::vector<jobject> evicted;
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+
+                    auto it = m_index.find(str);
+                    if (it != m_index.end()) {
+                        // other thread was faster, so its string is kept
+                        evicted.push_back(global);
+                    } else if (m_capacity > 0) {
+                        m_entries.emplace_front(str, global);
+                        m_index.emplace(str, m_entries.begin());
+                        evictOverflow(evicted);
+                    } else {
+                        evicted.push_back(global);
+                    }
+                }
+
+                deleteGlobalReferences(evicted);
+
+                return created;
+            }
+
+            void configure(std::size_t capacity, bool useJavaIntern)
+            {
+                std::vector<jobject> evicted;
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_capacity = capacity;
+                    m_useJavaIntern = useJavaIntern;
+                    evictOverflow(evicted);
+                }
+
+                deleteGlobalReferences(evicted);
+            }
+
+            void clear()
+            {
+                std::vector<jobject> evicted;
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+
+                    for (auto& entry : m_entries) {
+                        evicted.push_back(entry.second);
+                    }
+
+                    m_entries.clear();
+                    m_index.clear();
+                }
+
+                deleteGlobalReferences(evicted);
+            }
+
+            InternedJStringStatistics statistics() const
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                InternedJStringStatistics result;
+                result.hits = m_hits;
+                result.misses = m_misses;
+                result.evictions = m_evictions;
+                result.size = m_entries.size();
+                result.literals = 0;
+                return result;
+            }
+
+        private:
+            typedef std::list<std::pair<std::string, jobject>> Entries;
+
+            mutable std::mutex m_mutex;
+            std::size_t m_capacity;
+            bool m_useJavaIntern;
+            Entries m_entries;
+            std::unordered_map<std::string, Entries::iterator> m_index;
+            std::size_t m_hits;
+            std::size_t m_misses;
+            std::size_t m_evictions;
+
+            jstring createString(const std::string& str)
+            {
+                jstring created = createJString(str);
+
+                bool useJavaIntern;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    useJavaIntern = m_useJavaIntern;
+                }
+
+                if (created == nullptr || !useJavaIntern) {
+                    return created;
+                }
+
+                jstring canonical = callMethod<jstring>(created, "intern");
+                getCurrentJNIEnvironment()->DeleteLocalRef(created);
+
+                return canonical;
+            }
+
+            /**
+            * Should be called under the lock; references are deleted by the caller.
+            */
+            void evictOverflow(std::vector<jobject>& evicted)
+            {
+                while (m_entries.size() > m_capacity) {
+                    evicted.push_back(m_entries.back().second);
+                    m_index.erase(m_entries.back().first);
+                    m_entries.pop_back();
+                    ++m_evictions;
+                }
+            }
+
+            void deleteGlobalReferences(const std::vector<jobject>& references)
+            {
+                if (references.empty()) {
+                    return;
+                }
+
+                JNIEnv* env = getCurrentJNIEnvironment();
+                for (jobject object : references) {
+                    env->DeleteGlobalRef(object);
+                }
+            }
+        };
+
+        InternedStringCache& internedStringCache()
+        {
+            static InternedStringCache cache;
+            return cache;
+        }
+
+        std::atomic<std::size_t> literalCount(0);
+
+        jstring newGlobalJString(const char* str)
+        {
+            JNIEnv* env = getCurrentJNIEnvironment();
+
+            jstring local = createJString(str);
+            if (local == nullptr) {
+                reportInternalError("unable to create interned java string");
+                return nullptr;
+            }
+
+            jstring global = static_cast<jstring>(env->NewGlobalRef(local));
+            env->DeleteLocalRef(local);
+
+            if (global == nullptr) {
+                reportInternalError("unable to create global reference to interned java string");
+            }
+
+            return global;
+        }
+    }
+
+    jstring createPermanentJString(const char* str)
+    {
+        jstring global = newGlobalJString(str);
+        if (global != nullptr) {
+            literalCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return global;
+    }
+
+    jstring createPermanentJString(std::atomic<jstring>& cached, const char* str)
+    {
+        jstring global = newGlobalJString(str);
+        if (global == nullptr) {
+            return nullptr;
+        }
+
+        jstring expected = nullptr;
+        if (!cached.compare_exchange_strong(expected, global, std::memory_order_acq_rel)) {
+            // other thread was faster, so its string is kept
+            getCurrentJNIEnvironment()->DeleteGlobalRef(global);
+            return expected;
+        }
+
+        literalCount.fetch_add(1, std::memory_order_relaxed);
+
+        return global;
+    }
+
+    jstring internedJString(const std::string& str)
+    {
+        return internedStringCache().lookup(str);
+    }
+
+    void configureInternedJStrings(std::size_t capacity, bool useJavaIntern)
+    {
+        internedStringCache().configure(capacity, useJavaIntern);
+    }
+
+    void clearInternedJStrings()
+    {
+        internedStringCache().clear();
+    }
+
+    InternedJStringStatistics internedJStringStatistics()
+    {
+        InternedJStringStatistics result = internedStringCache().statistics();
+        result.literals = literalCount.load(std::memory_order_relaxed);
+        return result;
+    }
+}
@@ -0,0 +1,269 @@
+/**
+    \file JStringView.cpp
+    \brief Borrowed view of java string characters without copying.
+    \author Denis Sorokin
+    \date 12.03.2016
+*/
+
+#include <cstring>
+#include <utility>
+#include "../core/ErrorHandler.hpp"
+#include "../core/JNIEnvironment.hpp"
+#include "../utils/UnicodeTranscoder.hpp"
+#include "../utils/JStringView.hpp"
+
+namespace jh
+{
+    namespace
+    {
+        /**
+        * Reads UTF-16 code units one by one from the UTF-16 or (modified) UTF-8 text.
+        */
+        class CodeUnitReader
+        {
+        public:
+            CodeUnitReader(const jchar* utf16, std::size_t length)
+            : m_utf16(utf16)
+            , m_utf8(nullptr)
+            , m_size(length)
+            , m_position(0)
+            , m_pending(0)
+            , m_pendingCount(0)
+            {
+                // nothing to do here
+            }
+
+            CodeUnitReader(const char* utf8, std::size_t size)
+            : m_utf16(nullptr)
+            , m_utf8(utf8)
+            , m_size(size)
+            , m_position(0)
+            , m_pending(0)
+            , m_pendingCount(0)
+            {
+                // nothing to do here
+            }
+
+            bool next(jchar& unit)
+            {
+                if (m_pendingCount) {
+                    unit = m_pending;
+                    m_pendingCount = 0;
+                    return true;
+                }
+
+                if (m_position >= m_size) {
+                    return false;
+                }
+
+                if (m_utf16) {
+                    unit = m_utf16[m_position++];
+                    return true;
+                }
+
+                jchar units[2];
+                m_pendingCount = decodeUtf8Character(m_utf8, m_size, m_position, units) - 1;
+                m_pending = units[1];
+                unit = units[0];
+                return true;
+            }
+
+        private:
+            const jchar* m_utf16;
+            const char* m_utf8;
+            std::size_t m_size;
+            std::size_t m_position;
+            jchar m_pending;
+            std::size_t m_pendingCount;
+        };
+
+        bool sameCodeUnits(CodeUnitReader first, CodeUnitReader second)
+        {
+            jchar a;
+            jchar b;
+
+            while (true) {
+                bool hasFirst = first.next(a);
+                bool hasSecond = second.next(b);
+
+                if (hasFirst != hasSecond) {
+                    return false;
+                }
+
+                if (!hasFirst) {
+                    return true;
+                }
+
+                if (a != b) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    JStringView::JStringView()
+    : m_string(nullptr)
+    , m_access(JStringAccess::Critical)
+    , m_length(0)
+    , m_utf16(nullptr)
+    , m_utf8(nullptr)
+    , m_utf8Size(0)
+    {
+        // nothing to do here
+    }
+
+    JStringView::JStringView(jstring str, JStringAccess access)
+    : JStringView()
+    {
+        if (str == nullptr) {
+            return;
+        }
+
+        JNIEnv* env = getCurrentJNIEnvironment();
+
+        m_access = access;
+        m_length = static_cast<std::size_t>(env->GetStringLength(str));
+
+        if (access == JStringAccess::Critical) {
+            m_utf16 = env->GetStringCritical(str, nullptr);
+        } else {
+            m_utf8Size = static_cast<std::size_t>(env->GetStringUTFLength(str));
+            m_utf8 = env->GetStringUTFChars(str, nullptr);
+        }
+
+        if (m_utf16 == nullptr && m_utf8 == nullptr) {
+            reportInternalError("unable to access java string characters");
+            m_length = 0;
+            m_utf8Size = 0;
+            return;
+        }
+
+        m_string = str;
+    }
+
+    JStringView::JStringView(JStringView&& other)
+    : JStringView()
+    {
+        *this = std::move(other);
+    }
+
+    JStringView& JStringView::operator=(JStringView&& other)
+    {
+        if (&other == this)
+            return *this;
+
+        release();
+
+        std::swap(m_string, other.m_string);
+        std::swap(m_access, other.m_access);
+        std::swap(m_length, other.m_length);
+        std::swap(m_utf16, other.m_utf16);
+        std::swap(m_utf8, other.m_utf8);
+        std::swap(m_utf8Size, other.m_utf8Size);
+
+        return *this;
+    }
+
+    JStringView::~JStringView()
+    {
+        release();
+    }
+
+    void JStringView::release()
+    {
+        if (m_string) {
+            JNIEnv* env = getCurrentJNIEnvironment();
+
+            if (m_utf16) {
+                env->ReleaseStringCritical(m_string, m_utf16);
+            } else {
+                env->ReleaseStringUTFChars(m_string, m_utf8);
+            }
+        }
+
+        m_string = nullptr;
+        m_length = 0;
+        m_utf16 = nullptr;
+        m_utf8 = nullptr;
+        m_utf8Size = 0;
+    }
+
+    std::size_t JStringView::length() const
+    {
+        return m_length;
+    }
+
+    const jchar* JStringView::utf16() const
+    {
+        return m_utf16;
+    }
+
+    const char* JStringView::modifiedUtf8() const
+    {
+        return m_utf8;
+    }
+
+    std::size_t JStringView::modifiedUtf8Size() const
+    {
+        return m_utf8Size;
+    }
+
+    std::int32_t JStringView::hashCode() const
+    {
+        CodeUnitReader reader = m_utf16 ? CodeUnitReader(m_utf16, m_length) : CodeUnitReader(m_utf8, m_utf8Size);
+
+        // java relies on the overflow, so unsigned arithmetic is used here
+        std::uint32_t hash = 0;
+        jchar unit;
+        while (reader.next(unit)) {
+            hash = 31 * hash + unit;
+        }
+
+        return static_cast<std::int32_t>(hash);
+    }
+
+    bool JStringView::equals(const char* str, std::size_t size) const
+    {
+        if (!m_string) {
+            return false;
+        }
+
+        if (m_utf16) {
+            // every UTF-16 code unit takes from 1 to 3 UTF-8 bytes
+            if (size < m_length || size > m_length * kMaxUtf8BytesPerUtf16Unit) {
+                return false;
+            }
+
+            return sameCodeUnits(CodeUnitReader(m_utf16, m_length), CodeUnitReader(str, size));
+        }
+
+        // modified UTF-8 only differs from the standard one for zeros and supplementary characters
+        if (size == m_utf8Size && std::memcmp(m_utf8, str, size) == 0) {
+            return true;
+        }
+
+        return sameCodeUnits(CodeUnitReader(m_utf8, m_utf8Size), CodeUnitReader(str, size));
+    }
+
+    bool JStringView::equals(const char* str) const
+    {
+        return str != nullptr && equals(str, std::strlen(str));
+    }
+
+    bool JStringView::equals(const std::string& str) const
+    {
+        return equals(str.data(), str.size());
+    }
+
+#if __cplusplus >= 201703L
+    bool JStringView::equals(std::string_view str) const
+    {
+        return equals(str.data(), str.size());
+    }
+#endif
+
+    JStringView::operator bool() const
+    {
+        return m_string != nullptr;
+    }
+}
@@ -0,0 +1,142 @@
+/**
+    \file JStringView.hpp
+    \brief Borrowed view of java string characters without copying.
+    \author Denis Sorokin
+    \date 12.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // Borrow UTF-16 characters of the java string (no JNI calls until the view is released!):
+* {
+*     jh::JStringView view(js);
+*     if (view.equals("command")) {
+*         ...
+*     }
+* }
+*
+* // Borrow modified UTF-8 characters; other JNI calls are allowed here:
+* jh::JStringView view(js, jh::JStringAccess::ModifiedUtf8);
+* log(view.modifiedUtf8());
+*
+* // Same value as 'String.hashCode()' in java:
+* std::int32_t hash = view.hashCode();
+*
+* @endcode
+*/
+
+#ifndef JH_JSTRING_VIEW_HPP
+#define JH_JSTRING_VIEW_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <jni.h>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+namespace jh
+{
+    /**
+    * The way characters of the java string are borrowed.
+    */
+    enum class JStringAccess
+    {
+        Critical,       ///< UTF-16 characters with 'GetStringCritical'; usually no copy at all.
+        ModifiedUtf8    ///< Modified UTF-8 characters with 'GetStringUTFChars'; always a VM copy.
+    };
+
+    /**
+    * RAII view of the java string characters. Characters are released when the view
+    * is released or destroyed.
+    *
+    * @warning In 'JStringAccess::Critical' mode no JNI calls (including the creation of
+    * other critical views) are allowed while the view is alive.
+    */
+    class JStringView
+    {
+    public:
+        JStringView();
+
+        /**
+        * Borrows the characters of the java string.
+        *
+        * @param str Java string; the view is empty if it is null.
+        * @param access The way characters are borrowed.
+        */
+        explicit JStringView(jstring str, JStringAccess access = JStringAccess::Critical);
+
+        JStringView(JStringView&& other);
+        JStringView& operator=(JStringView&& other);
+        ~JStringView();
+
+        /**
+        * Gives the characters back to the VM.
+        */
+        void release();
+
+        /**
+        * Length of the string in UTF-16 code units (same as 'String.length()' in java).
+        */
+        std::size_t length() const;
+
+        /**
+        * UTF-16 characters; only available in 'JStringAccess::Critical' mode.
+        */
+        const jchar* utf16() const;
+
+        /**
+        * Zero-terminated modified UTF-8 characters; only available in 'JStringAccess::ModifiedUtf8' mode.
+        */
+        const char* modifiedUtf8() const;
+
+        /**
+        * Size of the modified UTF-8 characters in bytes.
+        */
+        std::size_t modifiedUtf8Size() const;
+
+        /**
+        * Calculates the same hash as 'String.hashCode()' in java.
+        */
+        std::int32_t hashCode() const;
+
+        /**
+        * Compares the viewed string with the UTF-8 text without any allocations.
+        *
+        * @param str UTF-8 text.
+        * @param size Size of the text in bytes.
+        * @return True if both strings consist of the same characters.
+        */
+        bool equals(const char* str, std::size_t size) const;
+
+        bool equals(const char* str) const;
+        bool equals(const std::string& str) const;
+
+#if __cplusplus >= 201703L
+        bool equals(std::string_view str) const;
+#endif
+
+        explicit operator bool() const;
+
+    private:
+        jstring m_string;
+        JStringAccess m_access;
+        std::size_t m_length;
+        const jchar* m_utf16;
+        const char* m_utf8;
+        std::size_t m_utf8Size;
+
+        /**
+        * View should not be copied.
+        */
+        JStringView(const JStringView &) = delete;
+        void operator=(const JStringView &) = delete;
+    };
+}
+
+#endif
@@ -5,7 +5,10 @@
     \date 28.01.2016
 */
 
+#include <utility>
 #include "../core/JNIEnvironment.hpp"
+#include "../core/Statistics.hpp"
+#include "../utils/DeferredRelease.hpp"
 #include "../utils/JavaObjectPointer.hpp"
 
 namespace jh
@@ -28,6 +31,12 @@ namespace jh
         reset(other);
     }
 
+    JavaObjectPointer::JavaObjectPointer(JavaObjectPointer&& other)
+    : m_jobjectGlobalReference(other.m_jobjectGlobalReference)
+    {
+        other.m_jobjectGlobalReference = nullptr;
+    }
+
     JavaObjectPointer::~JavaObjectPointer()
     {
         release();
@@ -48,8 +57,7 @@ namespace jh
         if (&other == this)
             return *this;
 
-        reset(other.get());
-        other.release();
+        std::swap(m_jobjectGlobalReference, other.m_jobjectGlobalReference);
 
         return *this;
     }
@@ -63,15 +71,15 @@ namespace jh
 
     void JavaObjectPointer::reset(jobject object)
     {
-        JNIEnv* env = getCurrentJNIEnvironment();
-
         if (object) {
-            object = env->NewGlobalRef(object);
+            object = getCurrentJNIEnvironment()->NewGlobalRef(object);
+            if (object) {
+                countStatistic(Statistic::LiveGlobalReferences);
+            }
         }
 
-        if (m_jobjectGlobalReference) {
-            env->DeleteGlobalRef(m_jobjectGlobalReference);
-        }
+        // can be called without JNIEnv when the pointer is released
+        releaseGlobalReference(m_jobjectGlobalReference);
 
         m_jobjectGlobalReference = object;
     }
@@ -93,6 +101,6 @@ namespace jh
 
     JavaObjectPointer::operator bool() const
     {
-        return !areEqual(get(), nullptr);
+        return get() != nullptr;
     }
 }
@@ -48,6 +48,7 @@ namespace jh
     /**
     * Java object (aka jobject) RAII wrapper that holds jobject as a global Java
     * reference. Can be assigned from jobject, casted to jobject and so on.
+    * Moves and null checks don't make JNI calls (see also jh::GlobalRef).
     */
     class JavaObjectPointer
     {
@@ -55,6 +56,7 @@ namespace jh
         JavaObjectPointer();
         JavaObjectPointer(jobject object);
         JavaObjectPointer(const JavaObjectPointer& other);
+        JavaObjectPointer(JavaObjectPointer&& other);
         ~JavaObjectPointer();
 
         JavaObjectPointer& operator=(const jobject other);
@@ -0,0 +1,384 @@
+/**
+    \file JavaReferences.hpp
+    \brief Typed RAII wrappers for local, global and weak java references.
+    \author Denis Sorokin
+    \date 15.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* JH_JAVA_CUSTOM_CLASS(Example, "com/class/path/Example");
+*
+* // Take ownership of the local reference returned by JNI (deleted on destruction):
+* jh::LocalRef<Example> local(jh::createNewObject<Example>());
+*
+* // Keep the object alive between JNI calls and threads:
+* jh::GlobalRef<Example> global(local);
+*
+* // Moves never call JNI, null checks are pointer tests:
+* jh::GlobalRef<Example> other = std::move(global);
+* if (!global)
+*     log("moved away");
+*
+* // Use as arguments of java calls:
+* jh::callMethod<void, Example>(other, "someMethod", local);
+*
+* // Track the object without keeping it alive:
+* jh::WeakRef<Example> weak(other);
+* if (auto strong = weak.lock())
+*     jh::callMethod<void>(strong, "stillAlive");
+*
+* // Give the local reference away (for example, as a native method result):
+* return local.detach();
+*
+* @endcode
+*/
+
+#ifndef JH_JAVA_REFERENCES_HPP
+#define JH_JAVA_REFERENCES_HPP
+
+#include <utility>
+#include <jni.h>
+#include "../core/ToJavaType.hpp"
+#include "../core/JNIEnvironment.hpp"
+#include "../core/Statistics.hpp"
+#include "../utils/DeferredRelease.hpp"
+
+namespace jh
+{
+    template<class JavaClass>
+    class WeakRef;
+
+    /**
+    * Owning local java reference; deleted with 'DeleteLocalRef' on destruction.
+    * Local references are only valid in the thread (and the native frame) where
+    * they were created, so this class can only be moved.
+    *
+    * @param JavaClass Custom java class (see JH_JAVA_CUSTOM_CLASS) or jobject-like JNI type.
+    */
+    template<class JavaClass = jobject>
+    class LocalRef
+    {
+    public:
+        using Type = typename ToJavaType<JavaClass>::Type;
+
+        LocalRef()
+        : m_object(nullptr)
+        {
+            // nothing to do here
+        }
+
+        /**
+        * Takes the ownership of the local reference; no JNI calls are made.
+        */
+        explicit LocalRef(jobject localReference)
+        : m_object(static_cast<Type>(localReference))
+        {
+            // nothing to do here
+        }
+
+        LocalRef(LocalRef&& other)
+        : m_object(other.m_object)
+        {
+            other.m_object = nullptr;
+        }
+
+        LocalRef& operator=(LocalRef&& other)
+        {
+            std::swap(m_object, other.m_object);
+            return *this;
+        }
+
+        ~LocalRef()
+        {
+            release();
+        }
+
+        /**
+        * Deletes the local reference.
+        */
+        void release()
+        {
+            if (m_object) {
+                getCurrentJNIEnvironment()->DeleteLocalRef(m_object);
+                m_object = nullptr;
+            }
+        }
+
+        /**
+        * Gives up the ownership of the local reference without deleting it.
+        */
+        Type detach()
+        {
+            Type object = m_object;
+            m_object = nullptr;
+            return object;
+        }
+
+        Type get() const
+        {
+            return m_object;
+        }
+
+        operator Type() const
+        {
+            return m_object;
+        }
+
+        explicit operator bool() const
+        {
+            return m_object != nullptr;
+        }
+
+    private:
+        Type m_object;
+
+        /**
+        * Local reference should not be copied.
+        */
+        LocalRef(const LocalRef &) = delete;
+        void operator=(const LocalRef &) = delete;
+    };
+
+    /**
+    * Owning global java reference; can be used from any attached thread and
+    * destroyed in any thread (see jh::releaseGlobalReference).
+    * Copies create new global references, moves don't call JNI at all.
+    *
+    * @param JavaClass Custom java class (see JH_JAVA_CUSTOM_CLASS) or jobject-like JNI type.
+    */
+    template<class JavaClass = jobject>
+    class GlobalRef
+    {
+    public:
+        using Type = typename ToJavaType<JavaClass>::Type;
+
+        GlobalRef()
+        : m_object(nullptr)
+        {
+            // nothing to do here
+        }
+
+        /**
+        * Creates a new global reference to the object (any kind of reference is accepted).
+        */
+        explicit GlobalRef(jobject object)
+        : m_object(nullptr)
+        {
+            if (object) {
+                m_object = static_cast<Type>(getCurrentJNIEnvironment()->NewGlobalRef(object));
+                if (m_object) {
+                    countStatistic(Statistic::LiveGlobalReferences);
+                }
+            }
+        }
+
+        GlobalRef(const GlobalRef& other)
+        : GlobalRef(other.get())
+        {
+            // nothing to do here
+        }
+
+        GlobalRef(GlobalRef&& other)
+        : m_object(other.m_object)
+        {
+            other.m_object = nullptr;
+        }
+
+        GlobalRef& operator=(const GlobalRef& other)
+        {
+            GlobalRef copy(other);
+            std::swap(m_object, copy.m_object);
+            return *this;
+        }
+
+        GlobalRef& operator=(GlobalRef&& other)
+        {
+            std::swap(m_object, other.m_object);
+            return *this;
+        }
+
+        ~GlobalRef()
+        {
+            release();
+        }
+
+        /**
+        * Deletes the global reference.
+        */
+        void release()
+        {
+            if (m_object) {
+                releaseGlobalReference(m_object);
+                m_object = nullptr;
+            }
+        }
+
+        /**
+        * Gives up the ownership of the global reference without deleting it.
+        */
+        Type detach()
+        {
+            Type object = m_object;
+            m_object = nullptr;
+            return object;
+        }
+
+        Type get() const
+        {
+            return m_object;
+        }
+
+        operator Type() const
+        {
+            return m_object;
+        }
+
+        explicit operator bool() const
+        {
+            return m_object != nullptr;
+        }
+
+    private:
+        friend class WeakRef<JavaClass>;
+
+        struct Adopt {};
+
+        GlobalRef(Type globalReference, Adopt)
+        : m_object(globalReference)
+        {
+            // nothing to do here
+        }
+
+        Type m_object;
+    };
+
+    /**
+    * Owning weak global java reference; doesn't keep the object alive.
+    * The object can only be used through 'lock()'.
+    *
+    * @param JavaClass Custom java class (see JH_JAVA_CUSTOM_CLASS) or jobject-like JNI type.
+    */
+    template<class JavaClass = jobject>
+    class WeakRef
+    {
+    public:
+        WeakRef()
+        : m_object(nullptr)
+        {
+            // nothing to do here
+        }
+
+        /**
+        * Creates a new weak global reference to the object.
+        */
+        explicit WeakRef(jobject object)
+        : m_object(nullptr)
+        {
+            if (object) {
+                m_object = getCurrentJNIEnvironment()->NewWeakGlobalRef(object);
+                if (m_object) {
+                    countStatistic(Statistic::LiveWeakReferences);
+                }
+            }
+        }
+
+        WeakRef(const WeakRef& other)
+        : WeakRef(other.m_object)
+        {
+            // nothing to do here
+        }
+
+        WeakRef(WeakRef&& other)
+        : m_object(other.m_object)
+        {
+            other.m_object = nullptr;
+        }
+
+        WeakRef& operator=(const WeakRef& other)
+        {
+            WeakRef copy(other);
+            std::swap(m_object, copy.m_object);
+            return *this;
+        }
+
+        WeakRef& operator=(WeakRef&& other)
+        {
+            std::swap(m_object, other.m_object);
+            return *this;
+        }
+
+        ~WeakRef()
+        {
+            release();
+        }
+
+        /**
+        * Deletes the weak global reference.
+        */
+        void release()
+        {
+            if (m_object) {
+                releaseWeakReference(m_object);
+                m_object = nullptr;
+            }
+        }
+
+        /**
+        * Promotes the reference to a global one.
+        *
+        * @return Global reference; it is empty if the object was already collected.
+        */
+        GlobalRef<JavaClass> lock() const
+        {
+            using Type = typename GlobalRef<JavaClass>::Type;
+
+            if (!m_object) {
+                return GlobalRef<JavaClass>();
+            }
+
+            jobject strong = getCurrentJNIEnvironment()->NewGlobalRef(m_object);
+            if (strong) {
+                countStatistic(Statistic::LiveGlobalReferences);
+            }
+            return GlobalRef<JavaClass>(static_cast<Type>(strong), typename GlobalRef<JavaClass>::Adopt());
+        }
+
+        /**
+        * Checks if the object was collected (makes a JNI call).
+        */
+        bool expired() const
+        {
+            return !m_object || getCurrentJNIEnvironment()->IsSameObject(m_object, nullptr);
+        }
+
+        /**
+        * Checks if the reference was ever set; says nothing about the object itself.
+        */
+        explicit operator bool() const
+        {
+            return m_object != nullptr;
+        }
+
+    private:
+        jweak m_object;
+    };
+
+    /**
+    * References can be used as argument types in the java calls.
+    */
+    template<class JavaClass>
+    struct ToJavaType<LocalRef<JavaClass>> : public ToJavaType<JavaClass>
+    {
+    };
+
+    template<class JavaClass>
+    struct ToJavaType<GlobalRef<JavaClass>> : public ToJavaType<JavaClass>
+    {
+    };
+}
+
+#endif
@@ -0,0 +1,346 @@
+/**
+    \file LatencyStats.hpp
+    \brief Call counters and latency histograms accumulated in per-thread shards.
+    \author Denis Sorokin
+    \date 22.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // Every kind of statistics has its own tag and its own per-thread shards:
+* struct DecoderStatsTag {};
+* using DecoderStats = jh::ShardedLatencyStats<DecoderStatsTag, 16>;
+*
+* // Slots are numbered from 1, slot 0 is ignored:
+* DecoderStats::record(1, elapsedNanoseconds);
+*
+* // Shards of all threads (including the finished ones) are merged on read:
+* jh::LatencySummary summary = DecoderStats::collect(1);
+* log(summary.calls, summary.p99Nanoseconds);
+*
+* @endcode
+*/
+
+#ifndef JH_LATENCY_STATS_HPP
+#define JH_LATENCY_STATS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+namespace jh
+{
+    /**
+    * Merged statistics of one slot. Percentiles are the lower bounds of their
+    * histogram buckets, so they are precise up to 12.5%.
+    */
+    struct LatencySummary
+    {
+        std::uint64_t calls;
+        std::uint64_t totalNanoseconds;
+        std::uint64_t maxNanoseconds;
+        std::uint64_t p50Nanoseconds;
+        std::uint64_t p90Nanoseconds;
+        std::uint64_t p99Nanoseconds;
+    };
+
+    /**
+    * HDR-style histogram: every power of two is split into 8 linear buckets.
+    * Values from 2^40 nanoseconds (about 18 minutes) up share the last bucket.
+    */
+    namespace latency
+    {
+        const int kSubBucketBits = 3;
+        const std::size_t kSubBucketCount = std::size_t(1) << kSubBucketBits;
+        const int kMaxExponent = 40;
+        const std::size_t kBucketCount = (kMaxExponent - kSubBucketBits + 1) * kSubBucketCount;
+
+        inline int highestBit(std::uint64_t value)
+        {
+            int bit = 0;
+            while (value >>= 1) {
+                ++bit;
+            }
+            return bit;
+        }
+
+        inline std::size_t bucketIndex(std::uint64_t nanoseconds)
+        {
+            if (nanoseconds < kSubBucketCount) {
+                return static_cast<std::size_t>(nanoseconds);
+            }
+
+            int exponent = highestBit(nanoseconds);
+            // the rows end before the row of 2^40
+            if (exponent >= kMaxExponent) {
+                return kBucketCount - 1;
+            }
+
+            std::size_t subBucket = static_cast<std::size_t>(nanoseconds >> (exponent - kSubBucketBits)) & (kSubBucketCount - 1);
+            return (exponent - kSubBucketBits + 1) * kSubBucketCount + subBucket;
+        }
+
+        /**
+        * @return The lowest value of the bucket.
+        */
+        inline std::uint64_t bucketValue(std::size_t index)
+        {
+            if (index < kSubBucketCount) {
+                return index;
+            }
+
+            int exponent = static_cast<int>(index / kSubBucketCount) + kSubBucketBits - 1;
+            std::uint64_t subBucket = index % kSubBucketCount;
+            return (kSubBucketCount + subBucket) << (exponent - kSubBucketBits);
+        }
+
+        inline std::uint64_t nowNanoseconds()
+        {
+            auto now = std::chrono::steady_clock::now().time_since_epoch();
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+        }
+    }
+
+    /**
+    * Counters of one slot in one thread. Only the owner thread writes them, so updates
+    * are plain relaxed loads and stores; readers may see a call that is half recorded.
+    */
+    struct LatencyCounters
+    {
+        std::atomic<std::uint64_t> calls;
+        std::atomic<std::uint64_t> totalNanoseconds;
+        std::atomic<std::uint64_t> maxNanoseconds;
+        std::atomic<std::uint64_t> buckets[latency::kBucketCount];
+
+        LatencyCounters()
+        : calls(0)
+        , totalNanoseconds(0)
+        , maxNanoseconds(0)
+        {
+            for (auto& bucket : buckets) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        void record(std::uint64_t nanoseconds)
+        {
+            increase(calls, 1);
+            increase(totalNanoseconds, nanoseconds);
+            increase(buckets[latency::bucketIndex(nanoseconds)], 1);
+
+            if (nanoseconds > maxNanoseconds.load(std::memory_order_relaxed)) {
+                maxNanoseconds.store(nanoseconds, std::memory_order_relaxed);
+            }
+        }
+
+        static void increase(std::atomic<std::uint64_t>& counter, std::uint64_t value)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+    };
+
+    /**
+    * Sums the counters of several threads.
+    */
+    class LatencyAccumulator
+    {
+    public:
+        LatencyAccumulator()
+        : m_calls(0)
+        , m_totalNanoseconds(0)
+        , m_maxNanoseconds(0)
+        , m_buckets()
+        {
+            // nothing to do here
+        }
+
+        void add(const LatencyCounters& counters)
+        {
+            m_calls += counters.calls.load(std::memory_order_relaxed);
+            m_totalNanoseconds += counters.totalNanoseconds.load(std::memory_order_relaxed);
+
+            std::uint64_t maxNanoseconds = counters.maxNanoseconds.load(std::memory_order_relaxed);
+            if (maxNanoseconds > m_maxNanoseconds) {
+                m_maxNanoseconds = maxNanoseconds;
+            }
+
+            for (std::size_t i = 0; i < latency::kBucketCount; ++i) {
+                m_buckets[i] += counters.buckets[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        LatencySummary summary() const
+        {
+            return {m_calls, m_totalNanoseconds, m_maxNanoseconds, percentile(50), percentile(90), percentile(99)};
+        }
+
+    private:
+        std::uint64_t m_calls;
+        std::uint64_t m_totalNanoseconds;
+        std::uint64_t m_maxNanoseconds;
+        std::uint64_t m_buckets[latency::kBucketCount];
+
+        std::uint64_t percentile(std::uint64_t percent) const
+        {
+            std::uint64_t histogramCalls = 0;
+            for (std::uint64_t count : m_buckets) {
+                histogramCalls += count;
+            }
+
+            if (histogramCalls == 0) {
+                return 0;
+            }
+
+            std::uint64_t rank = (histogramCalls * percent + 99) / 100;
+            std::uint64_t seen = 0;
+
+            for (std::size_t i = 0; i < latency::kBucketCount; ++i) {
+                seen += m_buckets[i];
+                if (seen >= rank) {
+                    return latency::bucketValue(i);
+                }
+            }
+
+            return m_maxNanoseconds;
+        }
+    };
+
+    /**
+    * Latency statistics of a fixed number of slots, accumulated in per-thread shards.
+    * Recording never takes locks (except once per thread); shards of the finished
+    * threads are reused by the new ones, so their counts are never lost.
+    *
+    * @param Tag Any type; every tag has its own shards.
+    * @param MaxSlots Number of slots; slot 0 is reserved for "not tracked".
+    */
+    template<class Tag, std::size_t MaxSlots>
+    class ShardedLatencyStats
+    {
+    public:
+        static void record(std::size_t slot, std::uint64_t nanoseconds)
+        {
+            if (slot == 0 || slot >= MaxSlots) {
+                return;
+            }
+
+            Shard* shard = threadShard();
+
+            LatencyCounters* counters = shard->slots[slot].load(std::memory_order_relaxed);
+            if (!counters) {
+                counters = new (std::nothrow) LatencyCounters();
+                if (!counters) {
+                    return;
+                }
+                shard->slots[slot].store(counters, std::memory_order_release);
+            }
+
+            counters->record(nanoseconds);
+        }
+
+        /**
+        * Merges the counters of the slot from all threads.
+        */
+        static LatencySummary collect(std::size_t slot)
+        {
+            LatencyAccumulator accumulator;
+
+            if (slot > 0 && slot < MaxSlots) {
+                for (Shard* shard = s_shards.load(std::memory_order_acquire); shard; shard = shard->next) {
+                    if (LatencyCounters* counters = shard->slots[slot].load(std::memory_order_acquire)) {
+                        accumulator.add(*counters);
+                    }
+                }
+            }
+
+            return accumulator.summary();
+        }
+
+    private:
+        struct Shard
+        {
+            std::atomic<LatencyCounters*> slots[MaxSlots];
+            Shard* next;
+            Shard* nextFree;
+
+            Shard()
+            : next(nullptr)
+            , nextFree(nullptr)
+            {
+                for (auto& slot : slots) {
+                    slot.store(nullptr, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        /**
+        * All shards ever created; the list only grows, so readers don't lock it.
+        */
+        static std::atomic<Shard*> s_shards;
+
+        /**
+        * Shards of the finished threads.
+        */
+        static std::mutex s_freeShardsMutex;
+        static Shard* s_freeShards;
+
+        struct ThreadShard
+        {
+            Shard* shard;
+
+            ThreadShard()
+            : shard(acquireShard())
+            {
+                // nothing to do here
+            }
+
+            ~ThreadShard()
+            {
+                std::lock_guard<std::mutex> lock(s_freeShardsMutex);
+                shard->nextFree = s_freeShards;
+                s_freeShards = shard;
+            }
+        };
+
+        static Shard* threadShard()
+        {
+            static thread_local ThreadShard threadShard;
+            return threadShard.shard;
+        }
+
+        static Shard* acquireShard()
+        {
+            {
+                std::lock_guard<std::mutex> lock(s_freeShardsMutex);
+                if (Shard* shard = s_freeShards) {
+                    s_freeShards = shard->nextFree;
+                    return shard;
+                }
+            }
+
+            Shard* shard = new Shard();
+            shard->next = s_shards.load(std::memory_order_relaxed);
+            while (!s_shards.compare_exchange_weak(shard->next, shard, std::memory_order_release, std::memory_order_relaxed)) {
+                // shard->next is updated by the failed exchange
+            }
+
+            return shard;
+        }
+    };
+
+    template<class Tag, std::size_t MaxSlots>
+    std::atomic<typename ShardedLatencyStats<Tag, MaxSlots>::Shard*> ShardedLatencyStats<Tag, MaxSlots>::s_shards(nullptr);
+
+    template<class Tag, std::size_t MaxSlots>
+    std::mutex ShardedLatencyStats<Tag, MaxSlots>::s_freeShardsMutex;
+
+    template<class Tag, std::size_t MaxSlots>
+    typename ShardedLatencyStats<Tag, MaxSlots>::Shard* ShardedLatencyStats<Tag, MaxSlots>::s_freeShards = nullptr;
+}
+
+#endif
@@ -0,0 +1,93 @@
+/**
+    \file SharedJavaObject.hpp
+    \brief Reference-counted owner of a single global java reference.
+    \author Denis Sorokin
+    \date 16.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // One global reference is created here:
+* jh::SharedJavaObject shared(jh::createNewObject<Example>());
+*
+* // Copies only increment an atomic counter (any thread, even without JNIEnv):
+* std::vector<jh::SharedJavaObject> owners(100, shared);
+* tasks.push([shared] { ... });
+*
+* // Can be used as an argument in java calls:
+* jh::callMethod<void, Example>(someObject, "someMethod", shared);
+*
+* // Global reference is deleted when the last owner is gone.
+*
+* @endcode
+*/
+
+#ifndef JH_SHARED_JAVA_OBJECT_HPP
+#define JH_SHARED_JAVA_OBJECT_HPP
+
+#include <cstddef>
+#include <jni.h>
+#include "../utils/JavaReferences.hpp"
+
+namespace jh
+{
+    /**
+    * Shared ownership of one global java reference. The reference lives in a control
+    * block with an atomic counter: copies and destructions of non-last owners make
+    * no JNI calls; the last owner deletes the global reference. If the last owner is
+    * destroyed in a thread without JNIEnv, the deletion is deferred (see jh::flushDeferredReleases).
+    */
+    class SharedJavaObject
+    {
+    public:
+        SharedJavaObject();
+
+        /**
+        * Creates the only global reference to the object.
+        */
+        explicit SharedJavaObject(jobject object);
+
+        /**
+        * Takes over the existing global reference; no JNI calls are made.
+        */
+        template<class JavaClass>
+        explicit SharedJavaObject(GlobalRef<JavaClass>&& reference)
+        : SharedJavaObject()
+        {
+            adopt(reference.detach());
+        }
+
+        SharedJavaObject(const SharedJavaObject& other);
+        SharedJavaObject(SharedJavaObject&& other);
+        SharedJavaObject& operator=(const SharedJavaObject& other);
+        SharedJavaObject& operator=(SharedJavaObject&& other);
+        ~SharedJavaObject();
+
+        /**
+        * Drops this owner; deletes the global reference if it was the last one.
+        */
+        void reset();
+
+        /**
+        * Number of owners of the reference (approximate if other threads copy it).
+        */
+        std::size_t useCount() const;
+
+        jobject get() const;
+
+        operator jobject() const;
+        explicit operator bool() const;
+
+    private:
+        struct ControlBlock;
+
+        ControlBlock* m_block;
+
+        void adopt(jobject globalReference);
+    };
+}
+
+#endif
@@ -0,0 +1,133 @@
+/**
+    \file ThreadPool.cpp
+    \brief Fixed-size pool of native worker threads.
+    \author Denis Sorokin
+    \date 01.03.2016
+*/
+
+#include "../utils/ThreadPool.hpp"
+
+namespace jh
+{
+    ThreadPool::ThreadPool(std::size_t concurrency)
+    : m_task(nullptr)
+    , m_taskCount(0)
+    , m_nextTask(0)
+    , m_busyWorkers(0)
+    , m_batchNumber(0)
+    , m_stopping(false)
+    {
+        if (concurrency == 0) {
+            concurrency = std::thread::hardware_concurrency();
+        }
+
+        for (std::size_t i = 1; i < concurrency; ++i) {
+            m_workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_batchStarted.notify_all();
+
+        for (auto& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    std::size_t ThreadPool::concurrency() const
+    {
+        return m_workers.size() + 1;
+    }
+
+    void ThreadPool::run(std::size_t taskCount, const std::function<void(std::size_t)>& task)
+    {
+        if (taskCount == 0) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> runLock(m_runMutex);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_task = &task;
+            m_taskCount = taskCount;
+            m_nextTask.store(0);
+            m_busyWorkers = m_workers.size();
+            ++m_batchNumber;
+        }
+
+        m_batchStarted.notify_all();
+
+        try {
+            executeTasks();
+        } catch (...) {
+            failBatch(std::current_exception());
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_batchFinished.wait(lock, [this] { return m_busyWorkers == 0; });
+        m_task = nullptr;
+
+        // workers are finished, so the task and everything it references can be safely destroyed
+        if (m_batchException) {
+            std::exception_ptr exception = m_batchException;
+            m_batchException = nullptr;
+            std::rethrow_exception(exception);
+        }
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        unsigned long long lastBatch = 0;
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_batchStarted.wait(lock, [&] { return m_stopping || m_batchNumber != lastBatch; });
+
+                if (m_stopping) {
+                    return;
+                }
+
+                lastBatch = m_batchNumber;
+            }
+
+            try {
+                executeTasks();
+            } catch (...) {
+                failBatch(std::current_exception());
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (--m_busyWorkers == 0) {
+                    m_batchFinished.notify_one();
+                }
+            }
+        }
+    }
+
+    void ThreadPool::executeTasks()
+    {
+        for (auto i = m_nextTask.fetch_add(1); i < m_taskCount; i = m_nextTask.fetch_add(1)) {
+            (*m_task)(i);
+        }
+    }
+
+    void ThreadPool::failBatch(std::exception_ptr exception)
+    {
+        // tasks that are not started yet are skipped
+        m_nextTask.store(m_taskCount);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_batchException) {
+            m_batchException = exception;
+        }
+    }
+}
@@ -0,0 +1,278 @@
+/**
+    \file UnicodeTranscoder.cpp
+    \brief UTF-8 <-> UTF-16 transcoding used by java string utilities.
+    \author Denis Sorokin
+    \date 11.03.2016
+*/
+
+#include <cstdint>
+#include <cstring>
+#include "../utils/UnicodeTranscoder.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace jh
+{
+    namespace
+    {
+        const jchar kReplacementCharacter = 0xFFFD;
+
+        /**
+        * Widens the longest block-aligned ASCII prefix of the UTF-8 text.
+        *
+        * @return Number of converted bytes.
+        */
+        std::size_t widenAscii(const unsigned char* src, std::size_t size, jchar* dst)
+        {
+            std::size_t i = 0;
+
+#if defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= size; i += 16) {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                if (_mm_movemask_epi8(bytes) != 0) {
+                    break;
+                }
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi8(bytes, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpackhi_epi8(bytes, zero));
+            }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+            for (; i + 16 <= size; i += 16) {
+                uint8x16_t bytes = vld1q_u8(src + i);
+                uint8x8_t folded = vorr_u8(vget_low_u8(bytes), vget_high_u8(bytes));
+                if (vget_lane_u64(vreinterpret_u64_u8(folded), 0) & 0x8080808080808080ULL) {
+                    break;
+                }
+
+                vst1q_u16(dst + i, vmovl_u8(vget_low_u8(bytes)));
+                vst1q_u16(dst + i + 8, vmovl_u8(vget_high_u8(bytes)));
+            }
+#endif
+
+            for (; i + 8 <= size; i += 8) {
+                std::uint64_t word;
+                std::memcpy(&word, src + i, sizeof(word));
+                if (word & 0x8080808080808080ULL) {
+                    break;
+                }
+
+                for (std::size_t k = 0; k < 8; ++k) {
+                    dst[i + k] = src[i + k];
+                }
+            }
+
+            return i;
+        }
+
+        /**
+        * Narrows the longest block-aligned ASCII prefix of the UTF-16 text.
+        *
+        * @return Number of converted code units.
+        */
+        std::size_t narrowAscii(const jchar* src, std::size_t length, unsigned char* dst)
+        {
+            std::size_t i = 0;
+
+#if defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+            for (; i + 16 <= length; i += 16) {
+                __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+                __m128i high = _mm_and_si128(_mm_or_si128(first, second), nonAscii);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF) {
+                    break;
+                }
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(first, second));
+            }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+            for (; i + 16 <= length; i += 16) {
+                uint16x8_t first = vld1q_u16(src + i);
+                uint16x8_t second = vld1q_u16(src + i + 8);
+                uint16x8_t combined = vorrq_u16(first, second);
+                uint16x4_t folded = vorr_u16(vget_low_u16(combined), vget_high_u16(combined));
+                if (vget_lane_u64(vreinterpret_u64_u16(folded), 0) & 0xFF80FF80FF80FF80ULL) {
+                    break;
+                }
+
+                vst1q_u8(dst + i, vcombine_u8(vmovn_u16(first), vmovn_u16(second)));
+            }
+#endif
+
+            for (; i + 4 <= length; i += 4) {
+                std::uint64_t word;
+                std::memcpy(&word, src + i, sizeof(word));
+                if (word & 0xFF80FF80FF80FF80ULL) {
+                    break;
+                }
+
+                for (std::size_t k = 0; k < 4; ++k) {
+                    dst[i + k] = static_cast<unsigned char>(src[i + k]);
+                }
+            }
+
+            return i;
+        }
+
+        bool isContinuation(unsigned char byte)
+        {
+            return (byte & 0xC0) == 0x80;
+        }
+    }
+
+    std::size_t decodeUtf8Character(const char* text, std::size_t size, std::size_t& position, jchar* units)
+    {
+        const unsigned char* src = reinterpret_cast<const unsigned char*>(text);
+        std::size_t i = position;
+        unsigned char lead = src[i];
+
+        if (lead < 0x80) {
+            units[0] = lead;
+            position = i + 1;
+            return 1;
+        }
+
+        std::size_t sequenceSize;
+        std::uint32_t codePoint;
+        std::uint32_t minCodePoint;
+
+        if ((lead & 0xE0) == 0xC0) {
+            sequenceSize = 2;
+            codePoint = lead & 0x1F;
+            minCodePoint = 0x80;
+        } else if ((lead & 0xF0) == 0xE0) {
+            sequenceSize = 3;
+            codePoint = lead & 0x0F;
+            minCodePoint = 0x800;
+        } else if ((lead & 0xF8) == 0xF0) {
+            sequenceSize = 4;
+            codePoint = lead & 0x07;
+            minCodePoint = 0x10000;
+        } else {
+            units[0] = kReplacementCharacter;
+            position = i + 1;
+            return 1;
+        }
+
+        bool truncated = i + sequenceSize > size;
+        for (std::size_t k = 1; !truncated && k < sequenceSize; ++k) {
+            if (!isContinuation(src[i + k])) {
+                truncated = true;
+            } else {
+                codePoint = (codePoint << 6) | (src[i + k] & 0x3F);
+            }
+        }
+
+        if (truncated) {
+            units[0] = kReplacementCharacter;
+            position = i + 1;
+            return 1;
+        }
+
+        position = i + sequenceSize;
+
+        // modified UTF-8 encodes zero with two bytes
+        bool modifiedZero = sequenceSize == 2 && codePoint == 0;
+
+        if ((codePoint < minCodePoint && !modifiedZero) || codePoint > 0x10FFFF) {
+            units[0] = kReplacementCharacter;
+            return 1;
+        }
+
+        if (codePoint >= 0x10000) {
+            codePoint -= 0x10000;
+            units[0] = static_cast<jchar>(0xD800 + (codePoint >> 10));
+            units[1] = static_cast<jchar>(0xDC00 + (codePoint & 0x3FF));
+            return 2;
+        }
+
+        // surrogate halves (CESU-8 / modified UTF-8) are kept, so a pair stays a pair
+        units[0] = static_cast<jchar>(codePoint);
+        return 1;
+    }
+
+    std::size_t utf8ToUtf16(const char* text, std::size_t size, jchar* dst)
+    {
+        const unsigned char* src = reinterpret_cast<const unsigned char*>(text);
+        std::size_t i = 0;
+        std::size_t out = 0;
+
+        while (i < size) {
+            unsigned char lead = src[i];
+
+            if (lead < 0x80) {
+                std::size_t converted = widenAscii(src + i, size - i, dst + out);
+                i += converted;
+                out += converted;
+
+                // the tail of the ASCII run that is shorter than a block
+                while (i < size && src[i] < 0x80) {
+                    dst[out++] = src[i++];
+                }
+
+                continue;
+            }
+
+            out += decodeUtf8Character(text, size, i, dst + out);
+        }
+
+        return out;
+    }
+
+    std::size_t utf16ToUtf8(const jchar* src, std::size_t length, char* text)
+    {
+        unsigned char* dst = reinterpret_cast<unsigned char*>(text);
+        std::size_t i = 0;
+        std::size_t out = 0;
+
+        while (i < length) {
+            std::uint32_t unit = src[i];
+
+            if (unit < 0x80) {
+                std::size_t converted = narrowAscii(src + i, length - i, dst + out);
+                i += converted;
+                out += converted;
+
+                while (i < length && src[i] < 0x80) {
+                    dst[out++] = static_cast<unsigned char>(src[i++]);
+                }
+
+                continue;
+            }
+
+            ++i;
+
+            if (unit < 0x800) {
+                dst[out++] = static_cast<unsigned char>(0xC0 | (unit >> 6));
+                dst[out++] = static_cast<unsigned char>(0x80 | (unit & 0x3F));
+                continue;
+            }
+
+            if (unit >= 0xD800 && unit <= 0xDFFF) {
+                bool paired = unit < 0xDC00 && i < length && src[i] >= 0xDC00 && src[i] <= 0xDFFF;
+                if (!paired) {
+                    unit = kReplacementCharacter;
+                } else {
+                    std::uint32_t codePoint = 0x10000 + ((unit - 0xD800) << 10) + (src[i++] - 0xDC00);
+                    dst[out++] = static_cast<unsigned char>(0xF0 | (codePoint >> 18));
+                    dst[out++] = static_cast<unsigned char>(0x80 | ((codePoint >> 12) & 0x3F));
+                    dst[out++] = static_cast<unsigned char>(0x80 | ((codePoint >> 6) & 0x3F));
+                    dst[out++] = static_cast<unsigned char>(0x80 | (codePoint & 0x3F));
+                    continue;
+                }
+            }
+
+            dst[out++] = static_cast<unsigned char>(0xE0 | (unit >> 12));
+            dst[out++] = static_cast<unsigned char>(0x80 | ((unit >> 6) & 0x3F));
+            dst[out++] = static_cast<unsigned char>(0x80 | (unit & 0x3F));
+        }
+
+        return out;
+    }
+}
@@ -0,0 +1,76 @@
+/**
+    \file UnicodeTranscoder.hpp
+    \brief UTF-8 <-> UTF-16 transcoding used by java string utilities.
+    \author Denis Sorokin
+    \date 11.03.2016
+*/
+
+/**
+* Cheat sheet:
+*
+* @code{.cpp}
+*
+* // UTF-8 to UTF-16; output buffer should have at least 'size' elements:
+* std::vector<jchar> chars(text.size());
+* chars.resize(jh::utf8ToUtf16(text.data(), text.size(), chars.data()));
+*
+* // UTF-16 to UTF-8; output buffer should have at least 'length * kMaxUtf8BytesPerUtf16Unit' bytes:
+* std::string text(chars.size() * jh::kMaxUtf8BytesPerUtf16Unit, '\0');
+* text.resize(jh::utf16ToUtf8(chars.data(), chars.size(), &text[0]));
+*
+* @endcode
+*/
+
+#ifndef JH_UNICODE_TRANSCODER_HPP
+#define JH_UNICODE_TRANSCODER_HPP
+
+#include <cstddef>
+#include <jni.h>
+
+namespace jh
+{
+    /**
+    * Largest number of UTF-8 bytes produced from a single UTF-16 code unit.
+    */
+    const std::size_t kMaxUtf8BytesPerUtf16Unit = 3;
+
+    /**
+    * Converts UTF-8 text to UTF-16. Runs of ASCII characters are widened in blocks
+    * (SSE2 or NEON when available, 64-bit words otherwise).
+    *
+    * Invalid sequences are replaced with U+FFFD. Modified UTF-8 is accepted too:
+    * two-byte zero (C0 80) and encoded surrogate halves are passed through as is.
+    *
+    * @param src UTF-8 text.
+    * @param size Size of the text in bytes.
+    * @param dst Output buffer; should have room for 'size' code units.
+    * @return Number of written UTF-16 code units.
+    */
+    std::size_t utf8ToUtf16(const char* src, std::size_t size, jchar* dst);
+
+    /**
+    * Decodes a single UTF-8 character with the same rules as 'utf8ToUtf16'.
+    *
+    * @param src UTF-8 text.
+    * @param size Size of the text in bytes.
+    * @param position Position of the character; moved to the next one.
+    * @param units Output buffer for at most two code units.
+    * @return Number of written UTF-16 code units.
+    */
+    std::size_t decodeUtf8Character(const char* src, std::size_t size, std::size_t& position, jchar* units);
+
+    /**
+    * Converts UTF-16 text to standard UTF-8 (supplementary characters become
+    * four-byte sequences). Runs of ASCII characters are narrowed in blocks.
+    *
+    * Unpaired surrogates are replaced with U+FFFD.
+    *
+    * @param src UTF-16 text.
+    * @param length Number of code units.
+    * @param dst Output buffer; should have room for 'length * kMaxUtf8BytesPerUtf16Unit' bytes.
+    * @return Number of written bytes.
+    */
+    std::size_t utf16ToUtf8(const jchar* src, std::size_t length, char* dst);
+}
+
+#endif
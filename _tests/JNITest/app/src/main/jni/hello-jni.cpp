@@ -1,4 +1,10 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
 #include <sstream>
+#include <thread>
+#include <vector>
 #include <jni.h>
 #include "JNIHelper.hpp"
 
@@ -11,6 +17,10 @@ inline std::string to_string(const T& t)
 }
 
 JH_JAVA_CUSTOM_CLASS(JavaExample, "com/quint/Example");
+JH_JAVA_CUSTOM_CLASS(JavaPeerExample, "com/quint/PeerExample");
+JH_JAVA_CUSTOM_CLASS(JavaIdentityExample, "com/quint/IdentityExample");
+JH_JAVA_CUSTOM_CLASS(JavaPeerCounter, "com/quint/PeerCounter");
+JH_JAVA_CUSTOM_CLASS(JavaNativeMethodStats, "com/jnihelper/NativeMethodStats");
 
 void testObjectCreation()
 {
@@ -139,6 +149,27 @@ void jstringTest()
     jh::reportInternalInfo("Рашн лангвич: [" + jh::jstringToStdString(jh::createJString("Рашн лангвич")) + "]");
     jh::reportInternalInfo("!@#$%^&*()[]{}|/.,: [" + jh::jstringToStdString(jh::createJString("!@#$%^&*()[]{}|/.,")) + "]");
     jh::reportInternalInfo("empty: [" + jh::jstringToStdString(jh::createJString("")) + "]");
+    jh::reportInternalInfo("part: [" + jh::jstringToStdString(jh::createJString("12345", 3)) + "]");
+
+    jh::reportInternalInfo("Lets compare java strings without copying...");
+    jstring js = jh::createJString("Рашн лангвич");
+    int javaHash = jh::callMethod<int>(js, "hashCode");
+
+    for (auto access : {jh::JStringAccess::Critical, jh::JStringAccess::ModifiedUtf8}) {
+        bool same;
+        bool different;
+        bool sameHash;
+        {
+            jh::JStringView view(js, access);
+            same = view.equals("Рашн лангвич");
+            different = view.equals("Рашн лангвиЧ");
+            sameHash = view.hashCode() == javaHash;
+        }
+
+        jh::reportInternalInfo("equal (should be 1): " + to_string(same));
+        jh::reportInternalInfo("different (should be 0): " + to_string(different));
+        jh::reportInternalInfo("same hash as java (should be 1): " + to_string(sameHash));
+    }
 
     jh::reportInternalInfo("Test #6: End.");
 }
@@ -168,17 +199,24 @@ public:
         jh::callMethod<void>(object(), "testNativeMethodArray");
     }
 
+    void testNativeShorts()
+    {
+        jh::callMethod<void>(object(), "testNativeMethodShorts");
+    }
+
 private:
     void linkJavaNativeMethods() override
     {
-        registerNativeMethod<1, void>("native1", &ExampleWrapper::native1);
-        registerNativeMethod<2, double, double, double>("native2", &ExampleWrapper::native2);
-        registerNativeMethod<3, jstring, jstring>("native3", &ExampleWrapper::native3);
-        registerNativeMethod<4, JavaExample>("native4", &ExampleWrapper::native4);
-        registerNativeMethod<5, void, JavaExample>("native5", &ExampleWrapper::native5);
-
-        registerNativeMethod<6, jintArray>("array7", &ExampleWrapper::array7);
-        registerNativeMethod<7, jstring, jh::JavaArray<jstring>>("array8", &ExampleWrapper::array8);
+        registerNativeMethod<&ExampleWrapper::native1>("native1");
+        registerNativeMethod<&ExampleWrapper::native2>("native2");
+        registerNativeMethod<&ExampleWrapper::native3>("native3");
+        registerNativeMethod<&ExampleWrapper::native4, JavaExample>("native4");
+        registerNativeMethod<&ExampleWrapper::native5, void, JavaExample>("native5");
+
+        registerNativeMethod<&ExampleWrapper::array7>("array7");
+        registerNativeMethod<&ExampleWrapper::array8, jstring, jh::JavaArray<jstring>>("array8");
+        registerNativeMethod<&ExampleWrapper::shorts1>("shorts1");
+        registerNativeMethod<&ExampleWrapper::normalize1>("normalize1");
     }
 
     jobject initializeJavaObject() override
@@ -196,10 +234,12 @@ private:
         return x + y;
     }
 
-    jstring native3(jstring s)
+    std::string native3(std::string_view s)
     {
-        std::string ss = jh::jstringToStdString(s);
-        return jh::createJString(ss + "X" + ss);
+        std::string result(s);
+        result += "X";
+        result += s;
+        return result;
     }
 
     jobject native4()
@@ -212,23 +252,52 @@ private:
         jh::callMethod<void>(example, "instance1");
     }
 
-    jintArray array7()
+    std::vector<jint> array7()
     {
-        return jh::JavaArrayBuilder<int>().add({6, 66, 666}).build();
+        return {6, 66, 666};
     }
 
     jstring array8(jobjectArray strings)
     {
-        auto allStrings = jh::jarrayToVector<jobjectArray>(strings);
+        std::string result;
+        std::string item;
 
-        std::string result = jh::jstringToStdString(static_cast<jstring>(allStrings[0]));
+        jh::forEachArrayElement(strings, [&](jobject element, int index) {
+            // the same buffer is reused for every string
+            jh::jstringToBuffer(static_cast<jstring>(element), item);
 
-        for (auto i = 1; i < allStrings.size(); ++i) {
-            result += "-" + jh::jstringToStdString(static_cast<jstring>(allStrings[i]));
-        }
+            if (index > 0) {
+                result += '-';
+            }
+            result += item;
+        });
 
         return jh::createJString(result);
     }
+
+    std::vector<jshort> shorts1(jh::Span<const jshort> samples)
+    {
+        std::vector<jshort> result;
+        for (auto sample : samples) {
+            result.push_back(static_cast<jshort>(-sample));
+        }
+
+        return result;
+    }
+
+    void normalize1(jh::Span<jfloat> values)
+    {
+        jfloat maximum = 0;
+        for (auto value : values) {
+            maximum = std::max(maximum, value);
+        }
+
+        if (maximum > 0) {
+            for (auto& value : values) {
+                value /= maximum;
+            }
+        }
+    }
 };
 
 void testNativeMethod()
@@ -297,6 +366,766 @@ void testArrayMethods()
     jh::reportInternalInfo("Test #9: End.");
 }
 
+void testParallelTransform()
+{
+    jh::reportInternalInfo("Test #10: Parallel array transform.");
+
+    jh::LocalReferenceFrame frame;
+    jh::ThreadPool pool(4);
+
+    std::vector<float> values(100003);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<float>(i);
+    }
+
+    jfloatArray array = jh::JavaArrayBuilder<float>().add(values.begin(), values.end()).build();
+
+    bool transformed = jh::parallelTransform(array, [] (jfloat* first, jfloat* last) {
+        for (auto it = first; it != last; ++it) {
+            *it = *it * 2.0f;
+        }
+    }, pool);
+
+    jh::parallelTransform(array, [] (jfloat* first, jfloat* last) {
+        for (auto it = first; it != last; ++it) {
+            *it = *it + 1.0f;
+        }
+    }, pool, jh::ArrayPinMode::Elements);
+
+    auto result = jh::jarrayToVector<jfloatArray>(array);
+
+    bool correct = transformed && result.size() == values.size();
+    for (std::size_t i = 0; correct && i < result.size(); ++i) {
+        correct = result[i] == values[i] * 2.0f + 1.0f;
+    }
+
+    jh::reportInternalInfo("Transformed array is correct (should be 1): " + to_string(correct));
+
+    jh::reportInternalInfo("Test #10: End.");
+}
+
+void testSmallPrimitiveTypes()
+{
+    jh::reportInternalInfo("Test #11: Byte, char and short types.");
+
+    jh::LocalReferenceFrame frame;
+
+    jobject o = jh::createNewObject<JavaExample>();
+
+    int8_t b = jh::callMethod<int8_t, int8_t>(o, "byte1", 41);
+    jh::reportInternalInfo("byte1 (should be 42): " + to_string(static_cast<int>(b)));
+
+    int16_t s = jh::callStaticMethod<JavaExample, int16_t, int16_t>("short1", 1000);
+    jh::reportInternalInfo("short1 (should be 2000): " + to_string(s));
+
+    char16_t c = jh::callMethod<char16_t, char16_t>(o, "char1", u'q');
+    jh::reportInternalInfo("char1 (should be 1): " + to_string(c == u'Q'));
+
+    jbyteArray bytes = jh::JavaArrayBuilder<int8_t>().add({1, 2, 3, 4}).build();
+    jbyteArray reversed = jh::callMethod<jbyteArray, jbyteArray>(o, "bytes1", bytes);
+    for (auto value : jh::jarrayToVector<jbyteArray>(reversed)) {
+        jh::reportInternalInfo("bytes1: " + to_string(static_cast<int>(value)));
+    }
+
+    ExampleWrapper wrapper;
+    wrapper.testNativeShorts();
+
+    jh::reportInternalInfo("Test #11: End.");
+}
+
+void testDirectBuffers()
+{
+    jh::reportInternalInfo("Test #12: Direct buffers.");
+
+    jh::LocalReferenceFrame frame;
+
+    jobject o = jh::createNewObject<JavaExample>();
+
+    std::unique_ptr<int8_t[]> memory(new int8_t[4]);
+    for (int i = 0; i < 4; ++i) {
+        memory[i] = static_cast<int8_t>(i + 1);
+    }
+
+    int8_t* rawMemory = memory.get();
+    jh::DirectBuffer buffer(std::move(memory), 4);
+
+    long sum = jh::callMethod<long, jh::DirectBuffer>(o, "buffer1", buffer);
+    jh::reportInternalInfo("buffer1 sum (should be 10): " + to_string(sum));
+    jh::reportInternalInfo("java wrote into native memory (should be 7): " + to_string(static_cast<int>(rawMemory[0])));
+
+    jh::DirectBufferView view(jh::callMethod<jh::DirectBuffer>(o, "buffer2"));
+    jh::reportInternalInfo("buffer2 size (should be 16): " + to_string(view.size()));
+    jh::reportInternalInfo("buffer2[15] (should be 15): " + to_string(static_cast<int>(static_cast<int8_t*>(view.data())[15])));
+
+    jh::reportInternalInfo("Test #12: End.");
+}
+
+void testDirectBufferPool()
+{
+    jh::reportInternalInfo("Test #13: Direct buffer pool.");
+
+    jh::LocalReferenceFrame frame;
+
+    jobject o = jh::createNewObject<JavaExample>();
+    jh::DirectBufferPool pool(16, 1024, 2);
+
+    for (int i = 0; i < 10; ++i) {
+        jh::DirectBufferPool::Lease first = pool.acquire(10);
+        jh::DirectBufferPool::Lease second = pool.acquire(100);
+        jh::callMethod<long, jh::DirectBuffer>(o, "buffer1", first);
+        jh::callMethod<long, jh::DirectBuffer>(o, "buffer1", second);
+    }
+
+    auto statistics = pool.statistics();
+    jh::reportInternalInfo("allocations (should be 2): " + to_string(statistics.allocations));
+    jh::reportInternalInfo("high water mark (should be 2): " + to_string(statistics.highWaterMark));
+    jh::reportInternalInfo("reuse rate (should be 0.9): " + to_string(statistics.reuseRate()));
+
+    jh::reportInternalInfo("Test #13: End.");
+}
+
+void testMappedFiles()
+{
+    jh::reportInternalInfo("Test #14: Memory-mapped files.");
+
+    jh::LocalReferenceFrame frame;
+
+    jobject o = jh::createNewObject<JavaExample>();
+    std::string path = jh::jstringToStdString(jh::callStaticMethod<JavaExample, jstring, int>("tempFile", 10000));
+
+    jh::MappedFile file = jh::mapFileToJava(path, 5000, 100, jh::MappingAccess::Sequential);
+    jh::reportInternalInfo("mapped size (should be 100): " + to_string(file.size()));
+    jh::reportInternalInfo("first byte in C++ (should be 8): " + to_string(static_cast<int>(static_cast<const char*>(file.data())[0])));
+
+    int first = jh::callMethod<int, jh::DirectBuffer>(o, "buffer3", file);
+    jh::reportInternalInfo("first byte in java (should be 8): " + to_string(first));
+
+    file.release();
+    jh::reportInternalInfo("released mapping is empty (should be 1): " + to_string(!file));
+
+    jh::reportInternalInfo("Test #14: End.");
+}
+
+void testSharedRingBuffer()
+{
+    jh::reportInternalInfo("Test #15: Shared ring buffer.");
+
+    jh::LocalReferenceFrame frame;
+
+    jobject o = jh::createNewObject<JavaExample>();
+    jh::SharedRingBuffer ring(256, jh::RingProducers::Multiple);
+
+    long expected = 0;
+    long received = 0;
+
+    for (int batch = 0; batch < 10; ++batch) {
+        for (int i = 0; i < 5; ++i) {
+            int record[2] = {batch, i};
+            ring.publish(record);
+            expected += batch + i;
+        }
+
+        std::string text = "variable-size record";
+        ring.publish(text.data(), text.size() / 4 * 4);
+        for (std::size_t i = 0; i + 4 <= text.size(); i += 4) {
+            int32_t word;
+            memcpy(&word, text.data() + i, 4);
+            expected += word;
+        }
+
+        ring.notifyConsumer();
+        received += jh::callMethod<long, jh::SharedRingBuffer>(o, "ring1", ring);
+    }
+
+    jh::reportInternalInfo("received sum is correct (should be 1): " + to_string(expected == received));
+    jh::reportInternalInfo("nothing is pending (should be 0): " + to_string(ring.pendingBytes()));
+
+    // the record doesn't fit between the end of the ring and its beginning even when the ring is empty
+    jh::SharedRingBuffer small(64);
+    int words[11] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+    small.publish(words, 36);
+    jh::callMethod<long, jh::SharedRingBuffer>(o, "ring1", small);
+    jh::reportInternalInfo("record after the end is postponed (should be 0): " + to_string(small.publish(words, 44)));
+    jh::callMethod<long, jh::SharedRingBuffer>(o, "ring1", small);
+    jh::reportInternalInfo("record is published after drain (should be 1): " + to_string(small.publish(words, 44)));
+    jh::reportInternalInfo("received sum (should be 11): " + to_string(jh::callMethod<long, jh::SharedRingBuffer>(o, "ring1", small)));
+
+    jh::reportInternalInfo("Test #15: End.");
+}
+
+/**
+* Measures 'iterations' round trips of the text through a java string.
+*/
+template<class RoundTrip>
+void benchmarkStringRoundTrip(const std::string& corpus, const std::string& text, int iterations, RoundTrip roundTrip)
+{
+    bool same = true;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        same = roundTrip(text) == text && same;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    jh::reportInternalInfo(corpus + ": " + to_string(elapsed.count() / iterations) + " us per round trip, "
+        + "text is unchanged (should be 1): " + to_string(same));
+}
+
+void testStringTranscoding()
+{
+    jh::reportInternalInfo("Test #16: UTF-16 string transcoding.");
+
+    JNIEnv* env = jh::getCurrentJNIEnvironment();
+    const int iterations = 200;
+
+    std::string ascii;
+    std::string cyrillic;
+    std::string emoji;
+    for (int i = 0; i < 200; ++i) {
+        ascii += "Plain ASCII text for the fast path. ";
+        cyrillic += "Рашн лангвич, много текста. ";
+        emoji += "Smile \xF0\x9F\x98\x80 rocket \xF0\x9F\x9A\x80 ";
+    }
+
+    auto utf16RoundTrip = [] (const std::string& text) {
+        jh::LocalReferenceFrame frame;
+        return jh::jstringToStdString(jh::createJString(text));
+    };
+
+    auto modifiedUtf8RoundTrip = [env] (const std::string& text) {
+        jh::LocalReferenceFrame frame;
+        jstring js = env->NewStringUTF(text.c_str());
+        const char* chars = env->GetStringUTFChars(js, nullptr);
+        std::string result(chars);
+        env->ReleaseStringUTFChars(js, chars);
+        return result;
+    };
+
+    jh::reportInternalInfo("NewString / GetStringRegion:");
+    benchmarkStringRoundTrip("ascii", ascii, iterations, utf16RoundTrip);
+    benchmarkStringRoundTrip("cyrillic", cyrillic, iterations, utf16RoundTrip);
+    benchmarkStringRoundTrip("emoji", emoji, iterations, utf16RoundTrip);
+
+    // modified UTF-8 can't carry four-byte sequences, so there is no emoji corpus here
+    jh::reportInternalInfo("NewStringUTF / GetStringUTFChars:");
+    benchmarkStringRoundTrip("ascii", ascii, iterations, modifiedUtf8RoundTrip);
+    benchmarkStringRoundTrip("cyrillic", cyrillic, iterations, modifiedUtf8RoundTrip);
+
+    jstring smile = jh::createJString("\xF0\x9F\x98\x80");
+    jh::reportInternalInfo("emoji is a surrogate pair (should be 2): " + to_string(env->GetStringLength(smile)));
+    env->DeleteLocalRef(smile);
+
+    jh::reportInternalInfo("Test #16: End.");
+}
+
+void testInternedStrings()
+{
+    jh::reportInternalInfo("Test #17: Interned java strings.");
+
+    jh::LocalReferenceFrame frame;
+
+    jstring first = nullptr;
+    bool sameLiteral = true;
+    int totalLength = 0;
+
+    for (int i = 0; i < 100; ++i) {
+        jstring literal = JH_INTERNED_JSTRING("some-constant-key");
+        totalLength += jh::callMethod<int>(literal, "length");
+
+        if (first == nullptr) {
+            first = literal;
+        }
+        sameLiteral = sameLiteral && literal == first;
+    }
+
+    jh::reportInternalInfo("literal length sum (should be 1700): " + to_string(totalLength));
+    jh::reportInternalInfo("literal is created once (should be 1): " + to_string(sameLiteral));
+
+    jh::clearInternedJStrings();
+    jh::configureInternedJStrings(8, true);
+    auto before = jh::internedJStringStatistics();
+
+    for (int i = 0; i < 100; ++i) {
+        jh::LocalReferenceFrame iterationFrame;
+        jh::internedJString("key" + to_string(i % 5));
+    }
+
+    jstring canonical = jh::internedJString("key0");
+    jstring javaLiteral = jh::callStaticMethod<JavaExample, jstring>("internedKey");
+    jh::reportInternalInfo("same object as java literal (should be 1): " + to_string(jh::areEqual(canonical, javaLiteral)));
+
+    for (int i = 0; i < 10; ++i) {
+        jh::LocalReferenceFrame iterationFrame;
+        jh::internedJString("other" + to_string(i));
+    }
+
+    auto after = jh::internedJStringStatistics();
+    jh::reportInternalInfo("hits (should be 96): " + to_string(after.hits - before.hits));
+    jh::reportInternalInfo("misses (should be 15): " + to_string(after.misses - before.misses));
+    jh::reportInternalInfo("evictions (should be 7): " + to_string(after.evictions - before.evictions));
+    jh::reportInternalInfo("cached (should be 8): " + to_string(after.size));
+    jh::reportInternalInfo("hit rate: " + to_string(after.hitRate()));
+
+    jh::configureInternedJStrings(256, false);
+
+    jh::reportInternalInfo("Test #17: End.");
+}
+
+void testStringArrays()
+{
+    jh::reportInternalInfo("Test #18: Bulk string arrays.");
+
+    jh::LocalReferenceFrame frame;
+    JNIEnv* env = jh::getCurrentJNIEnvironment();
+
+    std::vector<std::string> strings;
+    for (int i = 0; i < 1000; ++i) {
+        strings.push_back(i % 3 == 0 ? "ascii " + to_string(i) : i % 3 == 1 ? "Рашн " + to_string(i) : "\xF0\x9F\x98\x80" + to_string(i));
+    }
+    strings.push_back("");
+
+    jobjectArray javaStrings = jh::toJavaStringArray(strings);
+    jh::reportInternalInfo("java array size (should be 1001): " + to_string(env->GetArrayLength(javaStrings)));
+
+    jstring second = static_cast<jstring>(env->GetObjectArrayElement(javaStrings, 1));
+    jh::reportInternalInfo("second element (should be Рашн 1): " + jh::jstringToStdString(second));
+
+    std::vector<std::string> parsed = jh::fromJavaStringArray(javaStrings);
+    jh::reportInternalInfo("round trip is exact (should be 1): " + to_string(parsed == strings));
+
+    jobjectArray literals = jh::toJavaStringArray({"a", "b"});
+    jh::reportInternalInfo("initializer list (should be a-b): " + jh::fromJavaStringArray(literals)[0] + "-" + jh::fromJavaStringArray(literals)[1]);
+
+    jh::reportInternalInfo("Test #18: End.");
+}
+
+void testJavaReferences()
+{
+    jh::reportInternalInfo("Test #19: Typed java references.");
+
+    jh::LocalRef<JavaExample> local(jh::createNewObject<JavaExample>());
+    jh::GlobalRef<JavaExample> global(local);
+
+    jh::GlobalRef<JavaExample> moved = std::move(global);
+    jh::reportInternalInfo("moved-from is empty (should be 0): " + to_string(static_cast<bool>(global)));
+    jh::reportInternalInfo("moved-to is set (should be 1): " + to_string(static_cast<bool>(moved)));
+
+    jh::LocalRef<JavaExample> other(jh::callMethod<JavaExample>(moved, "instance5"));
+    jh::reportInternalInfo("instance3 through the local reference (should be 777): " + to_string(jh::callMethod<int>(other, "instance3")));
+    jh::callStaticMethod<JavaExample, void, jh::GlobalRef<JavaExample>>("static3", moved);
+
+    jh::LocalRef<jstring> text(jh::createJString("kanojo"));
+    jh::LocalRef<jstring> result(jh::callMethod<jstring, jstring>(other, "instance4", text));
+    jh::reportInternalInfo("instance4 returned: " + jh::jstringToStdString(result));
+
+    jh::WeakRef<JavaExample> weak(moved);
+    jh::reportInternalInfo("weak is alive (should be 1): " + to_string(static_cast<bool>(weak.lock())));
+
+    jh::JavaObjectPointer pointer(local);
+    jh::JavaObjectPointer movedPointer(std::move(pointer));
+    jh::reportInternalInfo("moved pointer (should be 0 1): " + to_string(static_cast<bool>(pointer)) + " " + to_string(static_cast<bool>(movedPointer)));
+
+    jh::reportInternalInfo("Test #19: End.");
+}
+
+void testSharedJavaObject()
+{
+    jh::reportInternalInfo("Test #20: Shared java objects.");
+
+    jh::SharedJavaObject shared(jh::GlobalRef<JavaExample>(jh::createNewObject<JavaExample>()));
+
+    {
+        // copies in the threads without JNIEnv are fine
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([shared] {
+                std::vector<jh::SharedJavaObject> copies(1000, shared);
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    jh::reportInternalInfo("only one owner left (should be 1): " + to_string(shared.useCount()));
+
+    std::vector<jh::SharedJavaObject> owners(10, shared);
+    jh::reportInternalInfo("owners (should be 11): " + to_string(shared.useCount()));
+    jh::reportInternalInfo("instance3 through the shared object (should be 777): " + to_string(jh::callMethod<int>(owners.back(), "instance3")));
+
+    owners.clear();
+    shared.reset();
+    jh::reportInternalInfo("released (should be 0): " + to_string(static_cast<bool>(shared)));
+
+    jh::reportInternalInfo("Test #20: End.");
+}
+
+void testDeferredReleases()
+{
+    jh::reportInternalInfo("Test #21: Deferred releases.");
+
+    jh::flushDeferredReleases();
+
+    jh::SharedJavaObject shared(jh::createNewObject<JavaExample>());
+    jh::GlobalRef<JavaExample> global(jh::createNewObject<JavaExample>());
+    jh::WeakRef<JavaExample> weak(global);
+
+    // this thread is not attached to the JVM, so the references are queued
+    std::thread([&] {
+        jh::SharedJavaObject last = std::move(shared);
+        jh::GlobalRef<JavaExample> dropped = std::move(global);
+        jh::WeakRef<JavaExample> droppedWeak = std::move(weak);
+    }).join();
+
+    jh::reportInternalInfo("queued (should be 3): " + to_string(jh::pendingDeferredReleases()));
+    jh::reportInternalInfo("flushed (should be 3): " + to_string(jh::flushDeferredReleases()));
+    jh::reportInternalInfo("queued (should be 0): " + to_string(jh::pendingDeferredReleases()));
+
+    jh::reportInternalInfo("Test #21: End.");
+}
+
+void testLocalReferenceBudget()
+{
+    jh::reportInternalInfo("Test #22: Local reference budget.");
+
+    jobject example = jh::createNewObject<JavaExample>();
+
+    // class references of the calls are freed, so the loop doesn't need any frame
+    int sum = 0;
+    for (int i = 0; i < 10000; ++i) {
+        sum += jh::callMethod<int>(example, "instance3");
+    }
+    jh::reportInternalInfo("sum (should be 7770000): " + to_string(sum));
+
+    jh::LocalReferenceFrame frame;
+    jstring first = jh::createJString("first");
+    jstring second = jh::createJString("second");
+    jobject third = jh::createNewObject<JavaExample>();
+    jh::createJString("not kept");
+    frame.popKeeping(&first, &second, &third);
+    jh::reportInternalInfo("survivors (should be first-second): " + jh::jstringToStdString(first) + "-" + jh::jstringToStdString(second));
+    jh::reportInternalInfo("object survived (should be 777): " + to_string(jh::callMethod<int>(third, "instance3")));
+
+    std::vector<std::string> names(5000, "name");
+    jobjectArray array = jh::toJavaStringArray(names);
+    std::size_t totalLength = 0;
+    jh::forEachArrayElement(array, [&](jobject element, int) {
+        totalLength += jh::jstringToStdString(static_cast<jstring>(element)).size();
+    });
+    jh::reportInternalInfo("total length (should be 20000): " + to_string(totalLength));
+
+    jh::reportInternalInfo("capacity reserved (should be 1): " + to_string(jh::ensureLocalCapacity(1000)));
+
+    jh::reportInternalInfo("Test #22: End.");
+}
+
+class PeerExampleWrapper : public jh::JavaObjectWrapper<JavaPeerExample, PeerExampleWrapper>
+{
+public:
+    PeerExampleWrapper(int id)
+    : m_id(id)
+    {
+        // nothing to do here
+    }
+
+private:
+    int m_id;
+
+    void linkJavaNativeMethods() override
+    {
+        registerNativeMethod<&PeerExampleWrapper::nativeId>("nativeId");
+        usePeerField("nativeHandle");
+    }
+
+    jobject initializeJavaObject() override
+    {
+        return jh::createNewObject<JavaPeerExample>();
+    }
+
+    int nativeId()
+    {
+        return m_id;
+    }
+};
+
+void testPeerDispatch()
+{
+    jh::reportInternalInfo("Test #23: Native peer dispatch.");
+
+    const int wrapperCount = 5000;
+
+    std::vector<std::unique_ptr<PeerExampleWrapper>> wrappers;
+    for (int i = 0; i < wrapperCount; ++i) {
+        wrappers.emplace_back(new PeerExampleWrapper(i));
+        wrappers.back()->object();
+    }
+
+    long long sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    jh::forEachInLocalFrames(wrapperCount, [&](int i) {
+        sum += jh::callMethod<int>(wrappers[i]->object(), "callNativeId");
+    });
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    jh::reportInternalInfo("sum of ids (should be 12497500): " + to_string(sum));
+    jh::reportInternalInfo(to_string(elapsed.count() * 1000 / wrapperCount) + " ns per native call with " + to_string(wrapperCount) + " wrappers");
+
+    jh::reportInternalInfo("Test #23: End.");
+}
+
+class IdentityExampleWrapper : public jh::JavaObjectWrapper<JavaIdentityExample, IdentityExampleWrapper>
+{
+public:
+    IdentityExampleWrapper(int id)
+    : m_id(id)
+    {
+        // nothing to do here
+    }
+
+private:
+    int m_id;
+
+    void linkJavaNativeMethods() override
+    {
+        // C++11 style registration is still supported
+        registerNativeMethod<1, int>("nativeId", &IdentityExampleWrapper::nativeId);
+    }
+
+    jobject initializeJavaObject() override
+    {
+        return jh::createNewObject<JavaIdentityExample>();
+    }
+
+    int nativeId()
+    {
+        return m_id;
+    }
+};
+
+void testIdentityRegistry()
+{
+    jh::reportInternalInfo("Test #24: Identity registry of wrappers.");
+
+    const int wrapperCount = 5000;
+    const int threadCount = 4;
+
+    std::vector<std::unique_ptr<IdentityExampleWrapper>> wrappers;
+    for (int i = 0; i < wrapperCount; ++i) {
+        wrappers.emplace_back(new IdentityExampleWrapper(i));
+        wrappers.back()->object();
+    }
+
+    jh::reportInternalInfo("registered (should be 1): " + to_string(IdentityExampleWrapper::nativeMethodsWereRegistered()));
+
+    // every thread calls the native method of every wrapper
+    std::vector<long long> sums(threadCount, 0);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            // native threads are not attached to the JVM by themselves
+            jh::JNIEnvironmentGuarantee guarantee;
+
+            jh::forEachInLocalFrames(wrapperCount, [&](int i) {
+                sums[t] += jh::callMethod<int>(wrappers[i]->object(), "callNativeId");
+            });
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    for (int t = 0; t < threadCount; ++t) {
+        jh::reportInternalInfo("sum of ids (should be 12497500): " + to_string(sums[t]));
+    }
+    jh::reportInternalInfo(to_string(elapsed.count() * 1000 / (wrapperCount * threadCount)) + " ns per native call with " + to_string(wrapperCount) + " wrappers");
+
+    jh::reportInternalInfo("Test #24: End.");
+}
+
+jint tableSum(JNIEnv*, jclass, jint x, jint y)
+{
+    return x + y;
+}
+
+jstring tableEcho(JNIEnv*, jclass, jstring s)
+{
+    return s;
+}
+
+JH_NATIVE_METHOD_TABLE(JavaExample,
+    JH_NATIVE_METHOD("tableSum", "(II)I", &tableSum),
+    JH_NATIVE_METHOD("tableEcho", "(Ljava/lang/String;)Ljava/lang/String;", &tableEcho)
+);
+
+void testNativeMethodTables()
+{
+    jh::reportInternalInfo("Test #25: Native method tables.");
+
+    std::vector<jh::NativeRegistrationTiming> timings;
+    bool registered = jh::registerAllNatives(&timings);
+
+    jh::reportInternalInfo("registered (should be 1): " + to_string(registered));
+    jh::reportInternalInfo("classes (should be 1): " + to_string(timings.size()));
+    jh::reportInternalInfo("methods (should be 2): " + to_string(timings.empty() ? 0 : timings[0].methodCount));
+
+    jh::reportInternalInfo("tableSum (should be 42): " + to_string(jh::callStaticMethod<JavaExample, int, int, int>("tableSum", 40, 2)));
+    jstring echo = jh::callStaticMethod<JavaExample, jstring, jstring>("tableEcho", jh::createJString("echo"));
+    jh::reportInternalInfo("tableEcho (should be echo): " + jh::jstringToStdString(echo));
+
+    timings.clear();
+    jh::registerAllNatives(&timings);
+    jh::reportInternalInfo("classes registered again (should be 0): " + to_string(timings.size()));
+
+    jh::reportInternalInfo("Test #25: End.");
+}
+
+class PeerCounter : public jh::JavaNativePeer<JavaPeerCounter, PeerCounter>
+{
+public:
+    static void linkJavaNativeMethods()
+    {
+        registerNativeMethod<&PeerCounter::increment>("increment");
+    }
+
+    int increment()
+    {
+        return ++m_value;
+    }
+
+private:
+    int m_value = 0;
+};
+
+void testJavaOwnedPeers()
+{
+    jh::reportInternalInfo("Test #26: Java-owned native peers.");
+
+    jh::reportInternalInfo("registered (should be 1): " + to_string(PeerCounter::registerPeerClass()));
+
+    const int objectCount = 1000;
+    long long sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    jh::forEachInLocalFrames(objectCount, [&](int) {
+        jobject counter = jh::createNewObject<JavaPeerCounter>();
+        jh::callMethod<int>(counter, "increment");
+        sum += jh::callMethod<int>(counter, "increment");
+        jh::callMethod<void>(counter, "close");
+    });
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    jh::PeerSlabStatistics statistics = PeerCounter::peerStatistics();
+    jh::reportInternalInfo("sum (should be 2000): " + to_string(sum));
+    jh::reportInternalInfo("live peers (should be 0): " + to_string(statistics.live));
+    jh::reportInternalInfo("chunks (should be 1): " + to_string(statistics.chunks));
+    jh::reportInternalInfo(to_string(elapsed.count() * 1000 / objectCount) + " ns per peer lifetime");
+
+    // this one is destroyed by the cleaner thread after the collection
+    jh::LocalRef<JavaPeerCounter> unclosed(jh::createNewObject<JavaPeerCounter>());
+    jh::reportInternalInfo("live peers (should be 1): " + to_string(PeerCounter::peerStatistics().live));
+
+    jh::reportInternalInfo("Test #26: End.");
+}
+
+void testNativeMethodStats()
+{
+    jh::reportInternalInfo("Test #27: Native method statistics.");
+
+    jh::LatencySummary increment = {};
+    for (const jh::NativeMethodStatistics& method : jh::nativeMethodStats()) {
+        if (method.className == JavaPeerCounter::className() && method.methodName == "increment") {
+            increment = method.latency;
+        }
+    }
+
+    jh::reportInternalInfo("increment calls (should be 2000): " + to_string(increment.calls));
+    jh::reportInternalInfo("percentiles are ordered (should be 1): " + to_string(increment.p50Nanoseconds <= increment.p99Nanoseconds && increment.p99Nanoseconds <= increment.maxNanoseconds));
+
+    // the largest latencies share the last bucket of the histogram
+    const std::uint64_t boundaries[] = {(1ull << 40) - 1, 1ull << 40, (1ull << 41) - 1, 1ull << 41, ~0ull};
+    bool insideHistogram = true;
+    jh::LatencyCounters counters;
+    for (std::uint64_t boundary : boundaries) {
+        insideHistogram = insideHistogram && jh::latency::bucketIndex(boundary) < jh::latency::kBucketCount;
+        counters.record(boundary);
+    }
+    jh::reportInternalInfo("boundary latencies inside histogram (should be 1): " + to_string(insideHistogram));
+    jh::reportInternalInfo("2^40 ns in the last bucket (should be 1): " + to_string(jh::latency::bucketIndex(1ull << 40) == jh::latency::kBucketCount - 1));
+    jh::reportInternalInfo("last bucket calls (should be 5): " + to_string(counters.buckets[jh::latency::kBucketCount - 1].load()));
+
+    jh::reportInternalInfo("dump registered (should be 1): " + to_string(jh::registerNativeMethodStatsDump()));
+    jstring dump = jh::callStaticMethod<JavaNativeMethodStats, jstring>("dump");
+    jh::reportInternalInfo("dump from java:\n" + jh::jstringToStdString(dump));
+
+    jh::reportInternalInfo("Test #27: End.");
+}
+
+void testJavaCallProfiling()
+{
+    jh::reportInternalInfo("Test #28: Java call profiling.");
+
+    const int callCount = 1000;
+
+    jh::JavaMethodCacheStatistics before = jh::javaMethodCacheStatistics();
+
+    jh::setJavaCallProfilingEnabled(true);
+    jh::setSlowJavaCallThreshold(1, 2);
+
+    jh::forEachInLocalFrames(callCount, [](int i) {
+        jh::callStaticMethod<JavaExample, int, int, int>("tableSum", i, 1);
+        jobject example = jh::createNewObject<JavaExample, int>(i);
+        jh::callMethod<int>(example, "get");
+    });
+
+    jh::setJavaCallProfilingEnabled(false);
+    jh::setSlowJavaCallThreshold(0);
+
+    jh::JavaMethodCacheStatistics after = jh::javaMethodCacheStatistics();
+    jh::reportInternalInfo("cache hits (should be at least 2997): " + to_string(after.hits - before.hits));
+
+    for (const jh::JavaCallProfile& profile : jh::javaCallProfiles()) {
+        if (profile.className == JavaExample::className()) {
+            jh::reportInternalInfo(profile.methodName + profile.signature + " calls (should be 1000): " + to_string(profile.call.calls)
+                + ", lookup p50 " + to_string(profile.lookup.p50Nanoseconds) + " ns, call p50 " + to_string(profile.call.p50Nanoseconds) + " ns");
+        }
+    }
+
+    jh::reportInternalInfo("Test #28: End.");
+}
+
+void testLibraryStatistics()
+{
+    jh::reportInternalInfo("Test #29: Library statistics.");
+
+    jh::Statistics before = jh::stats();
+
+    jh::forEachInLocalFrames(100, [](int i) {
+        jh::jstringToStdString(jh::createJString("1234"));
+        jh::JavaArrayBuilder<int>().add({i, i, i, i}).build();
+    });
+
+    jh::JavaObjectPointer example(jh::createNewObject<JavaExample, int>(5));
+
+    jh::Statistics after = jh::stats();
+
+    jh::reportInternalInfo("strings created (should be 100): " + to_string(after.stringsCreated - before.stringsCreated));
+    jh::reportInternalInfo("arrays created (should be 100): " + to_string(after.arraysCreated - before.arraysCreated));
+    jh::reportInternalInfo("objects created (should be 1): " + to_string(after.objectsCreated - before.objectsCreated));
+    jh::reportInternalInfo("bytes to java (should be 2400): " + to_string(after.bytesToJava - before.bytesToJava));
+    jh::reportInternalInfo("bytes from java (should be 800): " + to_string(after.bytesFromJava - before.bytesFromJava));
+    jh::reportInternalInfo("global references (should be 1): " + to_string(after.liveGlobalReferences - before.liveGlobalReferences));
+
+    example.release();
+    jh::reportInternalInfo("global references after release (should be 0): " + to_string(jh::stats().liveGlobalReferences - before.liveGlobalReferences));
+
+    jh::reportInternalInfo("Test #29: End.");
+}
+
 extern "C"
 {
     void Java_com_example_hellojni_HelloJni_performTest(JNIEnv*, jobject)
@@ -310,5 +1139,25 @@ extern "C"
         staticNativeMethodsTest();
         testNativeMethod();
         testArrayMethods();
+        testParallelTransform();
+        testSmallPrimitiveTypes();
+        testDirectBuffers();
+        testDirectBufferPool();
+        testMappedFiles();
+        testSharedRingBuffer();
+        testStringTranscoding();
+        testInternedStrings();
+        testStringArrays();
+        testJavaReferences();
+        testSharedJavaObject();
+        testDeferredReleases();
+        testLocalReferenceBudget();
+        testPeerDispatch();
+        testIdentityRegistry();
+        testNativeMethodTables();
+        testJavaOwnedPeers();
+        testNativeMethodStats();
+        testJavaCallProfiling();
+        testLibraryStatistics();
     }
 }